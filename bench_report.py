@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Run the in-guest scheduler benchmarks and print their results as a table.
+
+The `bench` program writes one line per measurement to COM1:
+
+    BENCH-TSC <tsc_hz>
+    BENCH-HZ <timer_hz>
+    BENCH <name> <samples> <min> <avg> <max>     (values in TSC cycles, '-' if unknown)
+    BENCH-DONE 0
+
+Usage:
+    python bench_report.py run <qemu command...>   # boot headless, stop at BENCH-DONE
+    python bench_report.py parse <serial.log>      # report from a captured log
+"""
+
+import argparse
+import subprocess
+import sys
+import threading
+from dataclasses import dataclass
+from typing import Iterable, List, Optional
+
+DEFAULT_TIMEOUT = 120.0
+
+
+@dataclass
+class Result:
+    name: str
+    samples: int
+    min: Optional[int]
+    avg: Optional[int]
+    max: Optional[int]
+
+
+@dataclass
+class Report:
+    tsc_hz: int = 0
+    timer_hz: int = 0
+    done: bool = False
+    results: List[Result] = None
+
+    def __post_init__(self):
+        if self.results is None:
+            self.results = []
+
+
+def parse_value(text: str) -> Optional[int]:
+    return None if text == '-' else int(text)
+
+
+def parse_line(report: Report, line: str) -> None:
+    fields = line.split()
+    if not fields:
+        return
+    tag = fields[0]
+    try:
+        if tag == 'BENCH-TSC' and len(fields) == 2:
+            report.tsc_hz = int(fields[1])
+        elif tag == 'BENCH-HZ' and len(fields) == 2:
+            report.timer_hz = int(fields[1])
+        elif tag == 'BENCH-DONE':
+            report.done = True
+        elif tag == 'BENCH' and len(fields) == 6:
+            report.results.append(Result(
+                fields[1], int(fields[2]),
+                parse_value(fields[3]), parse_value(fields[4]), parse_value(fields[5])))
+    except ValueError:
+        pass
+
+
+def parse_lines(lines: Iterable[str]) -> Report:
+    report = Report()
+    for line in lines:
+        parse_line(report, line)
+        if report.done:
+            break
+    return report
+
+
+def to_us(cycles: Optional[int], tsc_hz: int) -> str:
+    if cycles is None or tsc_hz == 0:
+        return '-'
+    return f'{cycles * 1_000_000 / tsc_hz:.2f}'
+
+
+def print_table(report: Report) -> None:
+    print(f'TSC {report.tsc_hz / 1e6:.1f} MHz, timer {report.timer_hz} Hz')
+    header = ('benchmark', 'samples', 'min us', 'avg us', 'max us', 'avg cycles')
+    rows = [header]
+    for r in report.results:
+        rows.append((r.name, str(r.samples),
+                     to_us(r.min, report.tsc_hz), to_us(r.avg, report.tsc_hz),
+                     to_us(r.max, report.tsc_hz), '-' if r.avg is None else str(r.avg)))
+    widths = [max(len(row[i]) for row in rows) for i in range(len(header))]
+    for i, row in enumerate(rows):
+        cells = [row[0].ljust(widths[0])] + [c.rjust(w) for c, w in zip(row[1:], widths[1:])]
+        print('  '.join(cells))
+        if i == 0:
+            print('  '.join('-' * w for w in widths))
+
+
+def run_qemu(command: List[str], timeout: float) -> Report:
+    proc = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                            stdin=subprocess.DEVNULL, text=True, errors='replace')
+    report = Report()
+    try:
+        timer = threading.Timer(timeout, proc.kill)
+        timer.start()
+        for line in proc.stdout:
+            parse_line(report, line)
+            if report.done:
+                break
+        timer.cancel()
+    finally:
+        proc.kill()
+        proc.wait()
+    return report
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='MeowOS scheduler benchmark report')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    run = sub.add_parser('run', help='boot QEMU headless and collect results')
+    run.add_argument('--timeout', type=float, default=DEFAULT_TIMEOUT)
+    run.add_argument('qemu', nargs=argparse.REMAINDER)
+    parse = sub.add_parser('parse', help='read a captured serial log')
+    parse.add_argument('log')
+    args = parser.parse_args()
+
+    if args.cmd == 'run':
+        if not args.qemu:
+            parser.error('missing qemu command')
+        report = run_qemu(args.qemu, args.timeout)
+    else:
+        with open(args.log, errors='replace') as f:
+            report = parse_lines(f)
+
+    if not report.results:
+        print('no benchmark results received', file=sys.stderr)
+        return 1
+    print_table(report)
+    if not report.done:
+        print('warning: run did not finish', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,5 +1,6 @@
 #include "framebuffer.h"
 #include "types/cpu.h"
+#include "kmem.h"
 
 static constexpr int ROWS = 25;
 static constexpr int COLS = 80;
@@ -42,6 +43,11 @@ void Framebuffer::init() {
 }
 
 void Framebuffer::putchar(char c) {
+    put_raw(c);
+    update_hw_cursor(row_, column_);
+}
+
+void Framebuffer::put_raw(char c) {
     if (c == '\n' || c == '\r') {
         row_++;
         column_ = 0;
@@ -49,7 +55,6 @@ void Framebuffer::putchar(char c) {
             scroll();
             row_ = ROWS - 1;
         }
-        update_hw_cursor(row_, column_);
         return;
     }
     if (c == '\b') {
@@ -61,7 +66,6 @@ void Framebuffer::putchar(char c) {
             column_ = COLS - 1;
             buffer_[row_][column_] = ' ' | (color_ << 8);
         }
-        update_hw_cursor(row_, column_);
         return;
     }
     if (column_ >= COLS) {
@@ -74,22 +78,31 @@ void Framebuffer::putchar(char c) {
     }
     buffer_[row_][column_] = (static_cast<uint8_t>(c) & 0xFF) | (color_ << 8);
     column_++;
-    update_hw_cursor(row_, column_);
 }
 
 void Framebuffer::puts(const char* str) {
     while (*str) {
-        putchar(*str++);
+        put_raw(*str++);
     }
+    sync_cursor();
 }
 
 void Framebuffer::write(const void* buf, unsigned int size) {
+    write_raw(buf, size);
+    sync_cursor();
+}
+
+void Framebuffer::write_raw(const void* buf, unsigned int size) {
     const char* p = reinterpret_cast<const char*>(buf);
     for (unsigned int i = 0; i < size; i++) {
-        putchar(p[i]);
+        put_raw(p[i]);
     }
 }
 
+void Framebuffer::sync_cursor() {
+    update_hw_cursor(row_, column_);
+}
+
 void Framebuffer::clear() {
     for (int i = 0; i < ROWS; i++) {
         for (int j = 0; j < COLS; j++) {
@@ -102,11 +115,7 @@ void Framebuffer::clear() {
 }
 
 void Framebuffer::scroll() {
-    for (int i = 0; i < ROWS - 1; i++) {
-        for (int j = 0; j < COLS; j++) {
-            buffer_[i][j] = buffer_[i + 1][j];
-        }
-    }
+    kmemmove(buffer_[0], buffer_[1], (ROWS - 1) * COLS * sizeof(uint16_t));
     for (int j = 0; j < COLS; j++) {
         buffer_[ROWS - 1][j] = ' ' | (color_ << 8);
     }
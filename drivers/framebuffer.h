@@ -8,6 +8,8 @@ private:
     int column_;
     uint16_t color_;
 
+    void put_raw(char c);
+
 public:
     Framebuffer();
     explicit Framebuffer(void* vga_buffer);
@@ -16,6 +18,8 @@ public:
     void putchar(char c);
     void puts(const char* str);
     void write(const void* buf, unsigned int size);
+    void write_raw(const void* buf, unsigned int size);
+    void sync_cursor();
     void clear();
     void scroll();
 
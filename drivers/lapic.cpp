@@ -0,0 +1,137 @@
+#include "lapic.h"
+#include "types/cpu.h"
+#include "types/kernel_info.h"
+#include "process.h"
+#include "timer.h"
+
+namespace {
+
+constexpr uint32_t IA32_APIC_BASE = 0x1B;
+constexpr uint64_t APIC_BASE_ENABLE = 1ULL << 11;
+constexpr uint32_t CPUID_APIC = 1u << 9;
+
+constexpr uint32_t REG_ID = 0x20;
+constexpr uint32_t REG_TPR = 0x80;
+constexpr uint32_t REG_EOI = 0xB0;
+constexpr uint32_t REG_SVR = 0xF0;
+constexpr uint32_t REG_ICR_LOW = 0x300;
+constexpr uint32_t REG_ICR_HIGH = 0x310;
+constexpr uint32_t REG_LVT_TIMER = 0x320;
+constexpr uint32_t REG_TIMER_INIT = 0x380;
+constexpr uint32_t REG_TIMER_CURRENT = 0x390;
+constexpr uint32_t REG_TIMER_DIVIDE = 0x3E0;
+
+constexpr uint32_t SVR_ENABLE = 1u << 8;
+constexpr uint32_t ICR_PENDING = 1u << 12;
+constexpr uint32_t ICR_ASSERT = 1u << 14;
+constexpr uint32_t ICR_ALL_BUT_SELF = 3u << 18;
+constexpr uint32_t ICR_INIT = 5u << 8;
+constexpr uint32_t ICR_STARTUP = 6u << 8;
+constexpr uint32_t LVT_MASKED = 1u << 16;
+constexpr uint32_t LVT_PERIODIC = 1u << 17;
+constexpr uint32_t TIMER_DIVIDE_16 = 0x3;
+
+constexpr uint32_t CALIBRATE_HZ = 100;
+
+}
+
+volatile uint32_t* Lapic::regs = nullptr;
+uint64_t Lapic::phys_base = 0;
+uint32_t Lapic::timer_count = 0;
+
+uint32_t Lapic::read(uint32_t reg) {
+    return regs[reg / 4];
+}
+
+void Lapic::write(uint32_t reg, uint32_t value) {
+    regs[reg / 4] = value;
+}
+
+void Lapic::wait_icr() {
+    while (read(REG_ICR_LOW) & ICR_PENDING)
+        asm volatile("pause");
+}
+
+bool Lapic::init() {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, eax, ebx, ecx, edx);
+    if (!(edx & CPUID_APIC))
+        return false;
+    uint64_t msr = rdmsr(IA32_APIC_BASE);
+    uint64_t base = msr & ~0xFFFULL & 0xFFFFFFFFFFULL;
+    if (!map_mmio_page(kernel_basic_info.pml4_table, base))
+        return false;
+    wrmsr(IA32_APIC_BASE, msr | APIC_BASE_ENABLE);
+    phys_base = base;
+    regs = reinterpret_cast<volatile uint32_t*>(base);
+    write(REG_SVR, (read(REG_SVR) & ~0xFFu) | SVR_ENABLE | SPURIOUS_VECTOR);
+    return true;
+}
+
+void Lapic::init_ap() {
+    wrmsr(IA32_APIC_BASE, rdmsr(IA32_APIC_BASE) | APIC_BASE_ENABLE);
+    write(REG_TPR, 0);
+    write(REG_SVR, SVR_ENABLE | SPURIOUS_VECTOR);
+}
+
+bool Lapic::available() {
+    return regs != nullptr;
+}
+
+uint64_t Lapic::base() {
+    return phys_base;
+}
+
+uint32_t Lapic::id() {
+    return read(REG_ID) >> 24;
+}
+
+void Lapic::eoi() {
+    write(REG_EOI, 0);
+}
+
+void Lapic::send_ipi(uint32_t apic_id, uint8_t vector) {
+    if (!regs)
+        return;
+    wait_icr();
+    write(REG_ICR_HIGH, apic_id << 24);
+    write(REG_ICR_LOW, ICR_ASSERT | vector);
+}
+
+void Lapic::broadcast_init() {
+    wait_icr();
+    write(REG_ICR_HIGH, 0);
+    write(REG_ICR_LOW, ICR_ALL_BUT_SELF | ICR_ASSERT | ICR_INIT);
+    wait_icr();
+}
+
+void Lapic::broadcast_startup(uint8_t page) {
+    wait_icr();
+    write(REG_ICR_HIGH, 0);
+    write(REG_ICR_LOW, ICR_ALL_BUT_SELF | ICR_ASSERT | ICR_STARTUP | page);
+    wait_icr();
+}
+
+bool Lapic::calibrate_timer(uint32_t hz) {
+    uint64_t tsc_hz = timer_tsc_hz();
+    if (!regs || tsc_hz == 0 || hz == 0)
+        return false;
+    write(REG_TIMER_DIVIDE, TIMER_DIVIDE_16);
+    write(REG_LVT_TIMER, LVT_MASKED | TIMER_VECTOR);
+    write(REG_TIMER_INIT, 0xFFFFFFFF);
+    uint64_t start = rdtsc();
+    while (rdtsc() - start < tsc_hz / CALIBRATE_HZ)
+        asm volatile("pause");
+    uint32_t elapsed = 0xFFFFFFFF - read(REG_TIMER_CURRENT);
+    write(REG_TIMER_INIT, 0);
+    timer_count = static_cast<uint32_t>(static_cast<uint64_t>(elapsed) * CALIBRATE_HZ / hz);
+    return timer_count != 0;
+}
+
+void Lapic::start_timer() {
+    if (!regs || timer_count == 0)
+        return;
+    write(REG_TIMER_DIVIDE, TIMER_DIVIDE_16);
+    write(REG_LVT_TIMER, LVT_PERIODIC | TIMER_VECTOR);
+    write(REG_TIMER_INIT, timer_count);
+}
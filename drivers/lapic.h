@@ -0,0 +1,30 @@
+#pragma once
+#include "types/types.h"
+
+class Lapic {
+private:
+    static volatile uint32_t* regs;
+    static uint64_t phys_base;
+    static uint32_t timer_count;
+
+    static uint32_t read(uint32_t reg);
+    static void write(uint32_t reg, uint32_t value);
+    static void wait_icr();
+
+public:
+    static constexpr uint8_t TIMER_VECTOR = 48;
+    static constexpr uint8_t RESCHEDULE_VECTOR = 49;
+    static constexpr uint8_t SPURIOUS_VECTOR = 63;
+
+    static bool init();
+    static void init_ap();
+    static bool available();
+    static uint64_t base();
+    static uint32_t id();
+    static void eoi();
+    static void send_ipi(uint32_t apic_id, uint8_t vector);
+    static void broadcast_init();
+    static void broadcast_startup(uint8_t page);
+    static bool calibrate_timer(uint32_t hz);
+    static void start_timer();
+};
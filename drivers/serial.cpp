@@ -0,0 +1,58 @@
+#include "serial.h"
+#include "types/cpu.h"
+
+bool Serial::present = false;
+
+namespace {
+constexpr uint16_t DATA = Serial::COM1;
+constexpr uint16_t INTERRUPT_ENABLE = Serial::COM1 + 1;
+constexpr uint16_t FIFO_CONTROL = Serial::COM1 + 2;
+constexpr uint16_t LINE_CONTROL = Serial::COM1 + 3;
+constexpr uint16_t MODEM_CONTROL = Serial::COM1 + 4;
+constexpr uint16_t LINE_STATUS = Serial::COM1 + 5;
+constexpr uint8_t LINE_STATUS_THR_EMPTY = 0x20;
+constexpr uint8_t LOOPBACK_PROBE = 0xAE;
+constexpr uint32_t TRANSMIT_SPIN_LIMIT = 100000;
+}
+
+bool Serial::init() {
+    outb(INTERRUPT_ENABLE, 0x00);
+    outb(LINE_CONTROL, 0x80);
+    outb(DATA, 0x01);
+    outb(INTERRUPT_ENABLE, 0x00);
+    outb(LINE_CONTROL, 0x03);
+    outb(FIFO_CONTROL, 0xC7);
+    outb(MODEM_CONTROL, 0x1E);
+    outb(DATA, LOOPBACK_PROBE);
+    present = inb(DATA) == LOOPBACK_PROBE;
+    outb(MODEM_CONTROL, 0x0F);
+    return present;
+}
+
+bool Serial::available() {
+    return present;
+}
+
+bool Serial::transmit_ready() {
+    for (uint32_t i = 0; i < TRANSMIT_SPIN_LIMIT; ++i) {
+        if (inb(LINE_STATUS) & LINE_STATUS_THR_EMPTY)
+            return true;
+        asm volatile("pause");
+    }
+    return false;
+}
+
+void Serial::putchar(char c) {
+    if (!present)
+        return;
+    if (c == '\n')
+        putchar('\r');
+    if (transmit_ready())
+        outb(DATA, static_cast<uint8_t>(c));
+}
+
+void Serial::write(const void* buf, uint32_t size) {
+    const char* p = static_cast<const char*>(buf);
+    for (uint32_t i = 0; i < size; ++i)
+        putchar(p[i]);
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "types/types.h"
+
+class Serial {
+private:
+    static bool present;
+
+    static bool transmit_ready();
+
+public:
+    static constexpr uint16_t COM1 = 0x3F8;
+
+    static bool init();
+    static bool available();
+    static void putchar(char c);
+    static void write(const void* buf, uint32_t size);
+};
@@ -0,0 +1,88 @@
+#include "tty.h"
+#include "keyboard.h"
+#include "framebuffer.h"
+#include "kmem.h"
+
+TtyMode Tty::mode = TtyMode::Canonical;
+char Tty::line[Tty::LINE_MAX];
+uint32_t Tty::line_len = 0;
+bool Tty::line_ready = false;
+
+void Tty::init() {
+    mode = TtyMode::Canonical;
+    line_len = 0;
+    line_ready = false;
+}
+
+TtyMode Tty::set_mode(TtyMode next) {
+    TtyMode prev = mode;
+    mode = next;
+    return prev;
+}
+
+TtyMode Tty::get_mode() {
+    return mode;
+}
+
+void Tty::cook() {
+    char echo[LINE_MAX];
+    uint32_t echo_len = 0;
+    while (!line_ready && Keyboard::has_char() && echo_len < LINE_MAX) {
+        char c = Keyboard::getchar();
+        if (c == '\b') {
+            if (line_len > 0) {
+                --line_len;
+                echo[echo_len++] = c;
+            }
+            continue;
+        }
+        if (c == '\r')
+            c = '\n';
+        if (c != '\n' && line_len + 1 >= LINE_MAX)
+            continue;
+        line[line_len++] = c;
+        echo[echo_len++] = c;
+        if (c == '\n')
+            line_ready = true;
+    }
+    if (echo_len > 0) {
+        g_framebuffer.write_raw(echo, echo_len);
+        g_framebuffer.sync_cursor();
+    }
+}
+
+uint32_t Tty::take(char* dst, uint32_t max_size) {
+    uint32_t n = line_len < max_size ? line_len : max_size;
+    kmemcpy(dst, line, n);
+    line_len -= n;
+    if (line_len > 0)
+        kmemmove(line, line + n, line_len);
+    else
+        line_ready = false;
+    return n;
+}
+
+bool Tty::readable() {
+    if (mode == TtyMode::Canonical) {
+        cook();
+        return line_ready;
+    }
+    return line_len > 0 || Keyboard::has_char();
+}
+
+uint32_t Tty::read(char* dst, uint32_t max_size) {
+    if (max_size == 0)
+        return 0;
+    if (mode == TtyMode::Canonical) {
+        cook();
+        return line_ready ? take(dst, max_size) : 0;
+    }
+    if (line_len > 0) {
+        line_ready = true;
+        return take(dst, max_size);
+    }
+    uint32_t n = 0;
+    while (n < max_size && Keyboard::has_char())
+        dst[n++] = Keyboard::getchar();
+    return n;
+}
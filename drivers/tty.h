@@ -0,0 +1,27 @@
+#pragma once
+#include "types/types.h"
+
+enum class TtyMode : uint64_t {
+    Canonical = 0,
+    Raw = 1
+};
+
+class Tty {
+private:
+    static constexpr uint32_t LINE_MAX = 256;
+
+    static TtyMode mode;
+    static char line[LINE_MAX];
+    static uint32_t line_len;
+    static bool line_ready;
+
+    static void cook();
+    static uint32_t take(char* dst, uint32_t max_size);
+
+public:
+    static void init();
+    static TtyMode set_mode(TtyMode next);
+    static TtyMode get_mode();
+    static uint32_t read(char* dst, uint32_t max_size);
+    static bool readable();
+};
@@ -1,8 +1,75 @@
 #include "fs/disk_io.h"
 #include "types/cpu.h"
+#include "kmem.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+#include "wait_queue.h"
 
 namespace fs {
 
+namespace {
+
+constexpr uint64_t IRQ_TIMEOUT_TICKS = 100;
+
+bool irq_enabled = false;
+bool irq_pending = false;
+WaitQueue irq_waiters;
+Process* owner = nullptr;
+uint32_t owner_depth = 0;
+WaitQueue lock_waiters;
+
+Process* blocking_caller() {
+    PerCpu& cpu = this_cpu();
+    if (!cpu.in_syscall)
+        return nullptr;
+    return cpu.current;
+}
+
+}
+
+void DiskIO::enable_irq() {
+    outb(CONTROL_PORT, 0x00);
+    irq_enabled = true;
+}
+
+void DiskIO::handle_interrupt() {
+    (void)inb(STATUS_PORT);
+    irq_pending = true;
+    irq_waiters.wake_all();
+}
+
+void DiskIO::acquire() {
+    Process* self = blocking_caller();
+    if (owner_depth > 0 && owner == self) {
+        ++owner_depth;
+        return;
+    }
+    while (owner_depth > 0 && self) {
+        lock_waiters.wait(*self);
+        self = blocking_caller();
+    }
+    owner = self;
+    owner_depth = 1;
+}
+
+void DiskIO::release() {
+    if (owner_depth == 0 || --owner_depth > 0)
+        return;
+    owner = nullptr;
+    lock_waiters.wake_one();
+}
+
+bool DiskIO::wait_irq(bool for_data) const {
+    Process* self = blocking_caller();
+    if (!irq_enabled || !self)
+        return wait_ready(for_data);
+    if (!irq_pending)
+        irq_waiters.wait(*self, IRQ_TIMEOUT_TICKS);
+    irq_pending = false;
+    return wait_ready(for_data);
+}
+
 bool DiskIO::wait_ready(bool for_data) const {
     for (int i = 0; i < 1000000; ++i) {
         uint8_t status = inb(STATUS_PORT);
@@ -24,6 +91,7 @@ bool DiskIO::select_drive(uint32_t lba) const {
     outb(LBA_LOW_PORT, lba & 0xFF);
     outb(LBA_MID_PORT, (lba >> 8) & 0xFF);
     outb(LBA_HIGH_PORT, (lba >> 16) & 0xFF);
+    irq_pending = false;
     return wait_ready(false);
 }
 
@@ -31,7 +99,7 @@ bool DiskIO::read_sector(uint32_t lba, void* buffer) {
     if (!select_drive(lba))
         return false;
     outb(COMMAND_PORT, CMD_READ);
-    if (!wait_ready(true))
+    if (!wait_irq(true))
         return false;
     uint16_t* ptr = static_cast<uint16_t*>(buffer);
     for (int i = 0; i < 256; ++i)
@@ -48,15 +116,16 @@ bool DiskIO::write_sector(uint32_t lba, const void* buffer) {
     const uint16_t* ptr = static_cast<const uint16_t*>(buffer);
     for (int i = 0; i < 256; ++i)
         outw(DATA_PORT, ptr[i]);
-    if (!wait_ready(false))
+    if (!wait_irq(false))
         return false;
     return flush();
 }
 
 bool DiskIO::flush() {
     outb(DEVICE_PORT, 0xE0);
+    irq_pending = false;
     outb(COMMAND_PORT, CMD_FLUSH);
-    return wait_ready(false);
+    return wait_irq(false);
 }
 
 bool DiskIO::identify(uint16_t* buffer) {
@@ -65,8 +134,9 @@ bool DiskIO::identify(uint16_t* buffer) {
     outb(LBA_LOW_PORT, 0);
     outb(LBA_MID_PORT, 0);
     outb(LBA_HIGH_PORT, 0);
+    irq_pending = false;
     outb(COMMAND_PORT, CMD_IDENTIFY);
-    if (!wait_ready(true))
+    if (!wait_irq(true))
         return false;
     for (int i = 0; i < 256; ++i)
         buffer[i] = inw(DATA_PORT);
@@ -113,8 +183,7 @@ bool DiskIO::read(uint64_t offset_bytes, void* buffer, uint32_t bytes) {
             uint8_t sector_buf[SECTOR_SIZE];
             if (!read_sector(lba, sector_buf))
                 return false;
-            for (uint32_t i = 0; i < chunk; ++i)
-                dst[i] = sector_buf[offset_in_sector + i];
+            kmemcpy(dst, sector_buf + offset_in_sector, chunk);
         }
         dst += chunk;
         offset_bytes += chunk;
@@ -144,8 +213,7 @@ bool DiskIO::write(uint64_t offset_bytes, const void* buffer, uint32_t bytes) {
             uint8_t sector_buf[SECTOR_SIZE];
             if (!read_sector(lba, sector_buf))
                 return false;
-            for (uint32_t i = 0; i < chunk; ++i)
-                sector_buf[offset_in_sector + i] = src[i];
+            kmemcpy(sector_buf + offset_in_sector, src, chunk);
             if (!write_sector(lba, sector_buf))
                 return false;
         }
@@ -7,6 +7,7 @@ class DiskIO {
 public:
     static constexpr uint32_t SECTOR_SIZE = 512;
     static constexpr uint32_t LBA28_MAX_SECTORS = 0x0FFFFFFF;
+    static constexpr uint8_t IRQ_VECTOR = 46;
 
     DiskIO() = default;
 
@@ -20,6 +21,11 @@ public:
     void set_disk_size(uint64_t bytes) { disk_size_ = bytes; }
     uint64_t disk_size() const { return disk_size_; }
 
+    static void enable_irq();
+    static void handle_interrupt();
+    static void acquire();
+    static void release();
+
 private:
     static constexpr uint16_t DATA_PORT = 0x1F0;
     static constexpr uint16_t ERROR_PORT = 0x1F1;
@@ -30,6 +36,7 @@ private:
     static constexpr uint16_t DEVICE_PORT = 0x1F6;
     static constexpr uint16_t COMMAND_PORT = 0x1F7;
     static constexpr uint16_t STATUS_PORT = 0x1F7;
+    static constexpr uint16_t CONTROL_PORT = 0x3F6;
 
     static constexpr uint8_t STATUS_BSY = 0x80;
     static constexpr uint8_t STATUS_DRQ = 0x08;
@@ -41,6 +48,7 @@ private:
     static constexpr uint8_t CMD_FLUSH = 0xE7;
 
     bool wait_ready(bool for_data) const;
+    bool wait_irq(bool for_data) const;
     bool select_drive(uint32_t lba) const;
     bool identify(uint16_t* buffer);
     bool flush();
@@ -48,4 +56,12 @@ private:
     uint64_t disk_size_ = 0;
 };
 
+class DiskLock {
+public:
+    DiskLock() { DiskIO::acquire(); }
+    ~DiskLock() { DiskIO::release(); }
+    DiskLock(const DiskLock&) = delete;
+    DiskLock& operator=(const DiskLock&) = delete;
+};
+
 }
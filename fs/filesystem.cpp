@@ -1,26 +1,8 @@
 #include "fs/filesystem.h"
+#include "kmem.h"
 
 namespace fs {
 
-static void copy_name(char* dst, const char* src) {
-    for (uint32_t i = 0; i < MAX_NAME_LEN; ++i) {
-        dst[i] = src[i];
-        if (src[i] == '\0')
-            break;
-    }
-    dst[MAX_NAME_LEN - 1] = '\0';
-}
-
-static bool names_equal(const char* a, const char* b) {
-    for (uint32_t i = 0; i < MAX_NAME_LEN; ++i) {
-        if (a[i] != b[i])
-            return false;
-        if (a[i] == '\0')
-            return true;
-    }
-    return true;
-}
-
 static uint32_t name_len(const char* s) {
     uint32_t i = 0;
     while (i < MAX_NAME_LEN && s[i] != '\0')
@@ -28,6 +10,14 @@ static uint32_t name_len(const char* s) {
     return i;
 }
 
+static void copy_name(char* dst, const char* src) {
+    uint32_t len = name_len(src);
+    if (len >= MAX_NAME_LEN)
+        len = MAX_NAME_LEN - 1;
+    kmemcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
 Error FileSystem::read_header_at(uint64_t offset, FileHeader& out) {
     if (!disk_.read(offset, &out, FILE_HEADER_SIZE))
         return Error::IOError;
@@ -40,62 +30,46 @@ Error FileSystem::write_header_at(uint64_t offset, const FileHeader& hdr) {
     return Error::Ok;
 }
 
-Error FileSystem::find_file(const char* name, uint64_t& out_offset, FileHeader& out_header, uint64_t* prev_offset) {
-    if (!mounted_ || !name)
-        return Error::InvalidArg;
+Error FileSystem::build_index() {
+    index_.clear();
     uint64_t cur = superblock_.first_file;
-    uint64_t prev = 0;
+    FileHeader hdr;
     while (cur != 0) {
-        Error e = read_header_at(cur, out_header);
+        Error e = read_header_at(cur, hdr);
         if (e != Error::Ok)
             return e;
-        if (out_header.in_use && names_equal(out_header.name, name)) {
-            out_offset = cur;
-            if (prev_offset)
-                *prev_offset = prev;
-            return Error::Ok;
+        IndexNode* node = NameIndex::make_node(cur, hdr);
+        if (!node)
+            return Error::NoSpace;
+        if (!index_.append(node)) {
+            NameIndex::free_node(node);
+            return Error::NoSpace;
         }
-        prev = cur;
-        cur = out_header.next_header;
+        cur = hdr.next_header;
     }
-    return Error::NotFound;
+    return Error::Ok;
 }
 
-Error FileSystem::find_tail(uint64_t& out_offset, FileHeader& out_header) {
-    if (!mounted_)
-        return Error::InvalidArg;
-    uint64_t cur = superblock_.first_file;
-    if (cur == 0) {
-        out_offset = 0;
-        return Error::Ok;
-    }
-    for (;;) {
-        Error e = read_header_at(cur, out_header);
+Error FileSystem::link_new_file(IndexNode* node) {
+    IndexNode* tail = index_.tail();
+    if (!tail) {
+        superblock_.first_file = node->offset;
+        if (!disk_.write(0, &superblock_, sizeof(Superblock)))
+            return Error::IOError;
+    } else {
+        FileHeader hdr = tail->header;
+        hdr.next_header = node->offset;
+        Error e = write_header_at(tail->offset, hdr);
         if (e != Error::Ok)
             return e;
-        if (out_header.next_header == 0) {
-            out_offset = cur;
-            return Error::Ok;
-        }
-        cur = out_header.next_header;
+        tail->header.next_header = node->offset;
     }
-}
-
-Error FileSystem::link_new_file(uint64_t new_header_offset) {
-    if (superblock_.first_file == 0) {
-        superblock_.first_file = new_header_offset;
-        return disk_.write(0, &superblock_, sizeof(Superblock)) ? Error::Ok : Error::IOError;
-    }
-    FileHeader tail;
-    uint64_t tail_offset;
-    Error e = find_tail(tail_offset, tail);
-    if (e != Error::Ok)
-        return e;
-    tail.next_header = new_header_offset;
-    return write_header_at(tail_offset, tail);
+    index_.append(node);
+    return Error::Ok;
 }
 
 Error FileSystem::format(uint64_t disk_size_bytes) {
+    DiskLock lock;
     if (disk_size_bytes < SUPERBLOCK_SIZE + FILE_HEADER_SIZE)
         return Error::InvalidArg;
     disk_.set_disk_size(disk_size_bytes);
@@ -106,11 +80,13 @@ Error FileSystem::format(uint64_t disk_size_bytes) {
     superblock_.disk_size = disk_size_bytes;
     if (!disk_.write(0, &superblock_, sizeof(Superblock)))
         return Error::IOError;
+    index_.clear();
     mounted_ = false;
     return Error::Ok;
 }
 
 Error FileSystem::mount() {
+    DiskLock lock;
     uint64_t disk_size = disk_.detect_disk_size();
     if (disk_size == 0)
         return Error::IOError;
@@ -120,11 +96,17 @@ Error FileSystem::mount() {
     if (superblock_.magic != FS_MAGIC || superblock_.disk_size == 0)
         return Error::InvalidArg;
     allocator_.init(disk_, superblock_);
+    Error e = build_index();
+    if (e != Error::Ok) {
+        index_.clear();
+        return e;
+    }
     mounted_ = true;
     return Error::Ok;
 }
 
 bool FileSystem::is_formatted() {
+    DiskLock lock;
     uint64_t disk_size = disk_.detect_disk_size();
     if (disk_size == 0)
         return false;
@@ -136,118 +118,162 @@ bool FileSystem::is_formatted() {
 }
 
 uint64_t FileSystem::detect_disk_size() {
+    DiskLock lock;
     return disk_.detect_disk_size();
 }
 
 Error FileSystem::create_file(const char* name) {
+    DiskLock lock;
     if (!mounted_ || !name)
         return Error::InvalidArg;
     if (name_len(name) == 0)
         return Error::InvalidArg;
-    FileHeader probe;
-    uint64_t dummy;
-    if (find_file(name, dummy, probe, nullptr) == Error::Ok)
+    if (index_.find(name))
         return Error::AlreadyExists;
-    uint64_t offset;
-    Error e = allocator_.allocate(static_cast<uint32_t>(FILE_HEADER_SIZE), offset);
-    if (e != Error::Ok)
-        return e;
     FileHeader hdr;
-    for (uint32_t i = 0; i < MAX_NAME_LEN; ++i)
-        hdr.name[i] = '\0';
+    kmemset(hdr.name, 0, MAX_NAME_LEN);
     copy_name(hdr.name, name);
     hdr.size = 0;
     hdr.next_header = 0;
     hdr.data_offset = 0;
     hdr.in_use = 1;
+    if (!index_.reserve())
+        return Error::NoSpace;
+    IndexNode* node = NameIndex::make_node(0, hdr);
+    if (!node)
+        return Error::NoSpace;
+    uint64_t offset;
+    Error e = allocator_.allocate(static_cast<uint32_t>(FILE_HEADER_SIZE), offset);
+    if (e != Error::Ok) {
+        NameIndex::free_node(node);
+        return e;
+    }
+    node->offset = offset;
     e = write_header_at(offset, hdr);
+    if (e == Error::Ok)
+        e = link_new_file(node);
     if (e != Error::Ok)
-        return e;
-    return link_new_file(offset);
+        NameIndex::free_node(node);
+    return e;
 }
 
 Error FileSystem::write_file(const char* name, const void* data, uint32_t size) {
-    if (!mounted_ || !name)
+    IoSegment seg = {data, size};
+    return write_file_vec(name, &seg, 1);
+}
+
+Error FileSystem::write_file_vec(const char* name, const IoSegment* segs, uint32_t count) {
+    DiskLock lock;
+    if (!mounted_ || !name || (count > 0 && !segs))
         return Error::InvalidArg;
-    FileHeader hdr;
-    uint64_t hdr_offset;
-    Error e = find_file(name, hdr_offset, hdr, nullptr);
-    if (e != Error::Ok)
-        return e;
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (segs[i].len > 0 && !segs[i].base)
+            return Error::InvalidArg;
+        if (segs[i].len > 0xFFFFFFFFu - size)
+            return Error::InvalidArg;
+        size += segs[i].len;
+    }
+    IndexNode* node = index_.find(name);
+    if (!node)
+        return Error::NotFound;
     uint64_t data_offset;
-    e = allocator_.allocate(size, data_offset);
+    Error e = allocator_.allocate(size, data_offset);
     if (e != Error::Ok)
         return e;
-    if (size > 0 && data && !disk_.write(data_offset, data, size))
-        return Error::IOError;
+    uint64_t pos = data_offset;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (segs[i].len == 0)
+            continue;
+        if (!disk_.write(pos, segs[i].base, segs[i].len))
+            return Error::IOError;
+        pos += segs[i].len;
+    }
+    FileHeader hdr = node->header;
     hdr.size = size;
     hdr.data_offset = data_offset;
-    return write_header_at(hdr_offset, hdr);
+    e = write_header_at(node->offset, hdr);
+    if (e != Error::Ok)
+        return e;
+    node->header = hdr;
+    return Error::Ok;
 }
 
 Error FileSystem::read_file(const char* name, void* buffer, uint32_t max_size, uint32_t* out_size) {
-    if (!mounted_ || !name || !buffer || !out_size)
+    if (!buffer)
         return Error::InvalidArg;
-    FileHeader hdr;
-    uint64_t dummy;
-    Error e = find_file(name, dummy, hdr, nullptr);
-    if (e != Error::Ok)
-        return e;
-    uint32_t to_read = hdr.size;
-    if (to_read > max_size)
-        to_read = max_size;
-    *out_size = to_read;
-    if (to_read == 0)
-        return Error::Ok;
+    IoBuffer buf = {buffer, max_size};
+    return read_file_vec(name, &buf, 1, out_size);
+}
+
+Error FileSystem::read_file_vec(const char* name, const IoBuffer* bufs, uint32_t count, uint32_t* out_size) {
+    DiskLock lock;
+    if (!mounted_ || !name || !out_size || (count > 0 && !bufs))
+        return Error::InvalidArg;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (bufs[i].len > 0 && !bufs[i].base)
+            return Error::InvalidArg;
+    }
+    IndexNode* node = index_.find(name);
+    if (!node)
+        return Error::NotFound;
+    const FileHeader& hdr = node->header;
+    *out_size = 0;
     if (hdr.data_offset == 0)
         return Error::Ok;
-    if (!disk_.read(hdr.data_offset, buffer, to_read))
-        return Error::IOError;
+    uint32_t done = 0;
+    for (uint32_t i = 0; i < count && done < hdr.size; ++i) {
+        uint32_t chunk = bufs[i].len;
+        if (chunk > hdr.size - done)
+            chunk = hdr.size - done;
+        if (chunk == 0)
+            continue;
+        if (!disk_.read(hdr.data_offset + done, bufs[i].base, chunk))
+            return Error::IOError;
+        done += chunk;
+    }
+    *out_size = done;
     return Error::Ok;
 }
 
 Error FileSystem::delete_file(const char* name) {
+    DiskLock lock;
     if (!mounted_ || !name)
         return Error::InvalidArg;
-    FileHeader hdr;
-    uint64_t hdr_offset;
-    uint64_t prev_offset;
-    Error e = find_file(name, hdr_offset, hdr, &prev_offset);
-    if (e != Error::Ok)
-        return e;
+    IndexNode* node = index_.find(name);
+    if (!node)
+        return Error::NotFound;
+    FileHeader hdr = node->header;
     hdr.in_use = 0;
-    e = write_header_at(hdr_offset, hdr);
+    Error e = write_header_at(node->offset, hdr);
     if (e != Error::Ok)
         return e;
-    if (prev_offset == 0) {
+    IndexNode* prev = node->prev;
+    if (!prev) {
         superblock_.first_file = hdr.next_header;
         if (!disk_.write(0, &superblock_, sizeof(Superblock)))
             return Error::IOError;
     } else {
-        FileHeader prev_hdr;
-        if (read_header_at(prev_offset, prev_hdr) != Error::Ok)
-            return Error::IOError;
+        FileHeader prev_hdr = prev->header;
         prev_hdr.next_header = hdr.next_header;
-        if (write_header_at(prev_offset, prev_hdr) != Error::Ok)
+        if (write_header_at(prev->offset, prev_hdr) != Error::Ok)
             return Error::IOError;
+        prev->header.next_header = hdr.next_header;
     }
+    index_.erase(node);
     return Error::Ok;
 }
 
 int FileSystem::list_files(char names[][MAX_NAME_LEN], int max) {
+    DiskLock lock;
     if (!mounted_ || !names || max <= 0)
         return -1;
     int count = 0;
-    uint64_t cur = superblock_.first_file;
-    FileHeader hdr;
-    while (cur != 0 && count < max) {
-        if (read_header_at(cur, hdr) != Error::Ok)
-            return -1;
-        if (hdr.in_use) {
-            copy_name(names[count], hdr.name);
+    for (IndexNode* node = index_.head(); node && count < max; node = node->next) {
+        if (node->header.in_use) {
+            copy_name(names[count], node->header.name);
             ++count;
         }
-        cur = hdr.next_header;
     }
     return count;
 }
@@ -3,9 +3,20 @@
 #include "fs/fs_error.h"
 #include "fs/disk_io.h"
 #include "fs/block_allocator.h"
+#include "fs/name_index.h"
 
 namespace fs {
 
+struct IoSegment {
+    const void* base;
+    uint32_t len;
+};
+
+struct IoBuffer {
+    void* base;
+    uint32_t len;
+};
+
 class FileSystem {
 public:
     FileSystem() = default;
@@ -19,19 +30,21 @@ public:
     Error create_file(const char* name);
     Error write_file(const char* name, const void* data, uint32_t size);
     Error read_file(const char* name, void* buffer, uint32_t max_size, uint32_t* out_size);
+    Error write_file_vec(const char* name, const IoSegment* segs, uint32_t count);
+    Error read_file_vec(const char* name, const IoBuffer* bufs, uint32_t count, uint32_t* out_size);
     Error delete_file(const char* name);
     int list_files(char names[][MAX_NAME_LEN], int max);
 
 private:
-    Error find_file(const char* name, uint64_t& out_offset, FileHeader& out_header, uint64_t* prev_offset);
-    Error find_tail(uint64_t& out_offset, FileHeader& out_header);
+    Error build_index();
     Error read_header_at(uint64_t offset, FileHeader& out);
     Error write_header_at(uint64_t offset, const FileHeader& hdr);
-    Error link_new_file(uint64_t new_header_offset);
+    Error link_new_file(IndexNode* node);
 
     DiskIO disk_;
     BlockAllocator allocator_;
     Superblock superblock_;
+    NameIndex index_;
     bool mounted_ = false;
 };
 
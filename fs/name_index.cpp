@@ -0,0 +1,155 @@
+#include "fs/name_index.h"
+#include "heap.h"
+#include "kmem.h"
+
+namespace fs {
+
+static bool names_equal(const char* a, const char* b) {
+    for (uint32_t i = 0; i < MAX_NAME_LEN; ++i) {
+        if (a[i] != b[i])
+            return false;
+        if (a[i] == '\0')
+            return true;
+    }
+    return true;
+}
+
+IndexNode* NameIndex::make_node(uint64_t offset, const FileHeader& header) {
+    IndexNode* node = static_cast<IndexNode*>(kmalloc(sizeof(IndexNode)));
+    if (!node)
+        return nullptr;
+    node->offset = offset;
+    kmemcpy(&node->header, &header, sizeof(FileHeader));
+    node->prev = nullptr;
+    node->next = nullptr;
+    node->hash = hash_name(header.name);
+    node->hashed = false;
+    return node;
+}
+
+void NameIndex::free_node(IndexNode* node) {
+    kfree(node);
+}
+
+uint32_t NameIndex::hash_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < MAX_NAME_LEN && name[i] != '\0'; ++i) {
+        hash ^= static_cast<uint8_t>(name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+size_t NameIndex::slot_for(uint32_t hash) const {
+    return static_cast<size_t>(hash) & (capacity_ - 1);
+}
+
+bool NameIndex::grow() {
+    size_t new_capacity = capacity_ ? capacity_ * 2 : INITIAL_CAPACITY;
+    IndexNode** new_slots = static_cast<IndexNode**>(kmalloc(new_capacity * sizeof(IndexNode*)));
+    if (!new_slots)
+        return false;
+    kmemset(new_slots, 0, new_capacity * sizeof(IndexNode*));
+    IndexNode** old_slots = slots_;
+    size_t old_capacity = capacity_;
+    slots_ = new_slots;
+    capacity_ = new_capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (!old_slots[i])
+            continue;
+        size_t s = slot_for(old_slots[i]->hash);
+        while (slots_[s])
+            s = (s + 1) & (capacity_ - 1);
+        slots_[s] = old_slots[i];
+    }
+    if (old_slots)
+        kfree(old_slots);
+    return true;
+}
+
+bool NameIndex::reserve() {
+    return (count_ + 1) * 2 <= capacity_ || grow();
+}
+
+bool NameIndex::append(IndexNode* node) {
+    if (node->header.in_use) {
+        if (!reserve())
+            return false;
+        size_t s = slot_for(node->hash);
+        while (slots_[s])
+            s = (s + 1) & (capacity_ - 1);
+        slots_[s] = node;
+        node->hashed = true;
+        ++count_;
+    }
+    node->next = nullptr;
+    node->prev = tail_;
+    if (tail_)
+        tail_->next = node;
+    else
+        head_ = node;
+    tail_ = node;
+    return true;
+}
+
+IndexNode* NameIndex::find(const char* name) const {
+    if (!name || capacity_ == 0)
+        return nullptr;
+    uint32_t hash = hash_name(name);
+    for (size_t s = slot_for(hash); slots_[s]; s = (s + 1) & (capacity_ - 1)) {
+        if (slots_[s]->hash == hash && names_equal(slots_[s]->header.name, name))
+            return slots_[s];
+    }
+    return nullptr;
+}
+
+void NameIndex::unhash(IndexNode* node) {
+    size_t s = slot_for(node->hash);
+    while (slots_[s] != node) {
+        if (!slots_[s])
+            return;
+        s = (s + 1) & (capacity_ - 1);
+    }
+    size_t hole = s;
+    for (size_t next = (hole + 1) & (capacity_ - 1); slots_[next]; next = (next + 1) & (capacity_ - 1)) {
+        size_t home = slot_for(slots_[next]->hash);
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = nullptr;
+    node->hashed = false;
+    --count_;
+}
+
+void NameIndex::erase(IndexNode* node) {
+    if (node->hashed)
+        unhash(node);
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        head_ = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
+    else
+        tail_ = node->prev;
+    free_node(node);
+}
+
+void NameIndex::clear() {
+    IndexNode* node = head_;
+    while (node) {
+        IndexNode* next = node->next;
+        free_node(node);
+        node = next;
+    }
+    head_ = nullptr;
+    tail_ = nullptr;
+    count_ = 0;
+    if (capacity_)
+        kmemset(slots_, 0, capacity_ * sizeof(IndexNode*));
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "fs/fs_structs.h"
+
+namespace fs {
+
+struct IndexNode {
+    uint64_t offset;
+    FileHeader header;
+    IndexNode* prev;
+    IndexNode* next;
+    uint32_t hash;
+    bool hashed;
+};
+
+class NameIndex {
+public:
+    static IndexNode* make_node(uint64_t offset, const FileHeader& header);
+    static void free_node(IndexNode* node);
+
+    bool reserve();
+    bool append(IndexNode* node);
+    IndexNode* find(const char* name) const;
+    void erase(IndexNode* node);
+    void clear();
+    IndexNode* head() const { return head_; }
+    IndexNode* tail() const { return tail_; }
+    size_t size() const { return count_; }
+
+private:
+    static constexpr size_t INITIAL_CAPACITY = 64;
+
+    static uint32_t hash_name(const char* name);
+    size_t slot_for(uint32_t hash) const;
+    bool grow();
+    void unhash(IndexNode* node);
+
+    IndexNode** slots_ = nullptr;
+    size_t capacity_ = 0;
+    size_t count_ = 0;
+    IndexNode* head_ = nullptr;
+    IndexNode* tail_ = nullptr;
+};
+
+}
@@ -17,9 +17,13 @@ extern "C" {
     void isr36();  void isr37();  void isr38();  void isr39();
     void isr40();  void isr41();  void isr42();  void isr43();
     void isr44();  void isr45();  void isr46();  void isr47();
+    void isr48();  void isr49();  void isr50();  void isr51();
+    void isr52();  void isr53();  void isr54();  void isr55();
+    void isr56();  void isr57();  void isr58();  void isr59();
+    void isr60();  void isr61();  void isr62();  void isr63();
 }
 
-static void* isr_table[48] = {
+static void* isr_table[64] = {
     reinterpret_cast<void*>(isr0),  reinterpret_cast<void*>(isr1),  reinterpret_cast<void*>(isr2),  reinterpret_cast<void*>(isr3),
     reinterpret_cast<void*>(isr4),  reinterpret_cast<void*>(isr5),  reinterpret_cast<void*>(isr6),  reinterpret_cast<void*>(isr7),
     reinterpret_cast<void*>(isr8),  reinterpret_cast<void*>(isr9),  reinterpret_cast<void*>(isr10), reinterpret_cast<void*>(isr11),
@@ -31,7 +35,11 @@ static void* isr_table[48] = {
     reinterpret_cast<void*>(isr32), reinterpret_cast<void*>(isr33), reinterpret_cast<void*>(isr34), reinterpret_cast<void*>(isr35),
     reinterpret_cast<void*>(isr36), reinterpret_cast<void*>(isr37), reinterpret_cast<void*>(isr38), reinterpret_cast<void*>(isr39),
     reinterpret_cast<void*>(isr40), reinterpret_cast<void*>(isr41), reinterpret_cast<void*>(isr42), reinterpret_cast<void*>(isr43),
-    reinterpret_cast<void*>(isr44), reinterpret_cast<void*>(isr45), reinterpret_cast<void*>(isr46), reinterpret_cast<void*>(isr47)
+    reinterpret_cast<void*>(isr44), reinterpret_cast<void*>(isr45), reinterpret_cast<void*>(isr46), reinterpret_cast<void*>(isr47),
+    reinterpret_cast<void*>(isr48), reinterpret_cast<void*>(isr49), reinterpret_cast<void*>(isr50), reinterpret_cast<void*>(isr51),
+    reinterpret_cast<void*>(isr52), reinterpret_cast<void*>(isr53), reinterpret_cast<void*>(isr54), reinterpret_cast<void*>(isr55),
+    reinterpret_cast<void*>(isr56), reinterpret_cast<void*>(isr57), reinterpret_cast<void*>(isr58), reinterpret_cast<void*>(isr59),
+    reinterpret_cast<void*>(isr60), reinterpret_cast<void*>(isr61), reinterpret_cast<void*>(isr62), reinterpret_cast<void*>(isr63)
 };
 
 void IDT::set_entry(uint8_t n, void* handler, uint8_t type) {
@@ -61,7 +69,7 @@ void IDT::remap_pic() {
 void IDT::init() {
     remap_pic();
 
-    for (int i = 0; i < 48; i++) {
+    for (int i = 0; i < 64; i++) {
         set_entry(i, isr_table[i], 0x8E);
     }
 
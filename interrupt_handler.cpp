@@ -1,33 +1,68 @@
 #include "interrupt_handler.h"
 #include "process.h"
 #include "scheduler.h"
+#include "percpu.h"
+#include "spinlock.h"
+#include "timer.h"
+#include "timer_queue.h"
 #include "syscall_handler.h"
 #include "drivers/keyboard.h"
+#include "drivers/lapic.h"
+#include "fs/disk_io.h"
+#include "fpu.h"
 #include "types/cpu.h"
 
-extern "C" void process_restore_and_switch_to_ctx(cpu_context_t* to_ctx, uint64_t new_cr3);
-extern "C" bool in_syscall;
+static void end_of_interrupt(uint64_t vector) {
+    if (vector >= Lapic::TIMER_VECTOR) {
+        Lapic::eoi();
+        return;
+    }
+    if (vector >= 40)
+        outb(0xA0, 0x20);
+    outb(0x20, 0x20);
+}
 
-extern "C" void interrupt_handler(cpu_context_t* ctx) {
-    if (ctx->int_no == 32) {
-        Process* saved_current = current_process;
-        if (saved_current && !in_syscall && ctx->rip >= saved_current->heap_start) {
-            uint64_t* s = reinterpret_cast<uint64_t*>(&saved_current->context);
-            uint64_t* f = reinterpret_cast<uint64_t*>(ctx);
-            for (size_t i = 0; i < 22; ++i)
-                s[i] = f[i];
-            Process* next = scheduler.tick();
-            if (next && next != saved_current) {
-                current_process = next;
-                outb(0x20, 0x20);
-                process_restore_and_switch_to_ctx(&next->context, next->get_cr3());
-            }
+static void handle_cpu_tick(cpu_context_t* ctx, uint64_t tick_start) {
+    PerCpu& cpu = this_cpu();
+    Process* saved_current = cpu.current;
+    if (saved_current && !cpu.in_syscall && ctx->rip >= saved_current->heap_start) {
+        Process* next = scheduler.tick();
+        if (next != saved_current) {
+            scheduler.record_tick_cost(rdtsc() - tick_start);
+            end_of_interrupt(ctx->int_no);
+            scheduler.switch_to(saved_current, next);
+            return;
         }
-        outb(0x20, 0x20);
-        return;
     }
-    if (ctx->int_no == 33) {
+    scheduler.record_tick_cost(rdtsc() - tick_start);
+    end_of_interrupt(ctx->int_no);
+}
+
+extern "C" void interrupt_handler(cpu_context_t* ctx) {
+    kernel_lock.lock();
+    if (ctx->int_no == Fpu::TRAP_VECTOR) {
+        Fpu::handle_trap();
+    } else if (ctx->int_no == 32) {
+        if (timer_idle_interrupt()) {
+            outb(0x20, 0x20);
+        } else {
+            uint64_t tick_start = rdtsc();
+            scheduler.account_tick();
+            scheduler.account_cpu_tick();
+            timer_queue.expire(scheduler.get_ticks());
+            handle_cpu_tick(ctx, tick_start);
+        }
+    } else if (ctx->int_no == 33) {
         Keyboard::handle_interrupt(ctx);
-        return;
+    } else if (ctx->int_no == fs::DiskIO::IRQ_VECTOR) {
+        fs::DiskIO::handle_interrupt();
+        end_of_interrupt(ctx->int_no);
+    } else if (ctx->int_no == Lapic::TIMER_VECTOR) {
+        uint64_t tick_start = rdtsc();
+        scheduler.account_cpu_tick();
+        handle_cpu_tick(ctx, tick_start);
+    } else if (ctx->int_no == Lapic::RESCHEDULE_VECTOR) {
+        Lapic::eoi();
     }
+    kernel_lock.unlock();
 }
@@ -3,15 +3,24 @@
 #include "syscall_handler.h"
 #include "types/idt.h"
 #include "drivers/keyboard.h"
+#include "drivers/tty.h"
 #include "drivers/framebuffer.h"
+#include "drivers/serial.h"
 #include "timer.h"
 #include "scheduler.h"
 #include "fs/filesystem.h"
 #include "fs/fs_error.h"
 #include "heap.h"
 #include "process.h"
+#include "process_pool.h"
+#include "kmem.h"
+#include "percpu.h"
+#include "smp.h"
+#include "idle.h"
+#include "fpu.h"
+#include "spinlock.h"
+#include "drivers/lapic.h"
 
-extern "C" void process_restore_and_switch_to_ctx(cpu_context_t* to_ctx, uint64_t new_cr3);
 
 kernel_basic_info_t kernel_basic_info{};
 
@@ -20,12 +29,102 @@ fs::FileSystem* g_fs = nullptr;
 namespace {
 constexpr uint32_t MAX_INIT_SIZE = 256 * 1024;
 constexpr uint64_t HEAP_START_VIRT = 0x2000000;
+
+bool cmdline_key_matches(const char* token, const char* key) {
+    while (*key) {
+        if (*token != *key)
+            return false;
+        ++token;
+        ++key;
+    }
+    return *token == '=';
+}
+
+const char* cmdline_value(const char* cmdline, const char* key) {
+    const char* p = cmdline;
+    while (*p) {
+        while (*p == ' ')
+            ++p;
+        if (cmdline_key_matches(p, key)) {
+            while (*p != '=')
+                ++p;
+            return p + 1;
+        }
+        while (*p && *p != ' ')
+            ++p;
+    }
+    return nullptr;
+}
+
+bool cmdline_value_is(const char* value, const char* word) {
+    while (*word) {
+        if (*value != *word)
+            return false;
+        ++value;
+        ++word;
+    }
+    return *value == '\0' || *value == ' ';
+}
+
+void cmdline_copy_word(const char* value, char* out, size_t out_size) {
+    size_t i = 0;
+    while (i + 1 < out_size && value[i] && value[i] != ' ') {
+        out[i] = value[i];
+        ++i;
+    }
+    out[i] = '\0';
+}
+
+bool cmdline_get_uint(const char* cmdline, const char* key, uint64_t& out) {
+    const char* p = cmdline_value(cmdline, key);
+    if (!p)
+        return false;
+    uint64_t value = 0;
+    bool any = false;
+    while (*p >= '0' && *p <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        any = true;
+        ++p;
+    }
+    if (any)
+        out = value;
+    return any;
+}
+
+void parse_cmdline(const char* cmdline) {
+    uint64_t value;
+    if (cmdline_get_uint(cmdline, "hz", value) && value > 0 && value <= MAX_TIMER_HZ)
+        kernel_basic_info.timer_hz = static_cast<uint32_t>(value);
+    if (cmdline_get_uint(cmdline, "quantum", value) && value > 0)
+        kernel_basic_info.quantum = value;
+    const char* sched = cmdline_value(cmdline, "sched");
+    if (sched && cmdline_value_is(sched, "mlfq"))
+        kernel_basic_info.sched_policy = static_cast<uint32_t>(SchedPolicy::Mlfq);
+    else if (sched && cmdline_value_is(sched, "rr"))
+        kernel_basic_info.sched_policy = static_cast<uint32_t>(SchedPolicy::RoundRobin);
+    if (cmdline_get_uint(cmdline, "cpus", value) && value > 0 && value <= MAX_CPUS)
+        kernel_basic_info.max_cpus = static_cast<uint32_t>(value);
+    const char* init = cmdline_value(cmdline, "init");
+    if (init && *init && *init != ' ')
+        cmdline_copy_word(init, kernel_basic_info.init_name, INIT_NAME_LEN);
+    const char* sysprof = cmdline_value(cmdline, "sysprof");
+    if (sysprof && cmdline_value_is(sysprof, "off"))
+        kernel_basic_info.syscall_profiling = false;
+    else if (sysprof && cmdline_value_is(sysprof, "on"))
+        kernel_basic_info.syscall_profiling = true;
+}
 }
 
 
 void parse_multiboot(multiboot_info_t* multiboot_info) {
     uint32_t total = multiboot_info->header.total_size;
     char* p = reinterpret_cast<char*>(multiboot_info) + 8;
+    kernel_basic_info.timer_hz = DEFAULT_TIMER_HZ;
+    kernel_basic_info.quantum = Scheduler::DEFAULT_QUANTUM;
+    kernel_basic_info.sched_policy = static_cast<uint32_t>(SchedPolicy::RoundRobin);
+    kernel_basic_info.max_cpus = MAX_CPUS;
+    kernel_basic_info.syscall_profiling = true;
+    cmdline_copy_word("init", kernel_basic_info.init_name, INIT_NAME_LEN);
 
     while (p + 8 <= reinterpret_cast<char*>(multiboot_info) + total) {
         multiboot_tag_header_t* tag = reinterpret_cast<multiboot_tag_header_t*>(p);
@@ -33,6 +132,7 @@ void parse_multiboot(multiboot_info_t* multiboot_info) {
             break;
         switch (tag->type) {
             case MULTIBOOT2_TAG_CMDLINE:
+                parse_cmdline(reinterpret_cast<multiboot2_tag_string_t*>(p)->string);
                 break;
             case MULTIBOOT2_TAG_BASIC_MEM: {
                 multiboot2_tag_basic_mem_t* mem = reinterpret_cast<multiboot2_tag_basic_mem_t*>(p);
@@ -53,8 +153,10 @@ void parse_multiboot(multiboot_info_t* multiboot_info) {
 
 void kernel_init(int magic, multiboot_info_t* multiboot_info) {
     parse_multiboot(multiboot_info);
+    kmem_init();
     kernel_basic_info.frame_buffer = reinterpret_cast<uint16_t(*)[80]>(0xB8000);
     g_framebuffer.init();
+    Serial::init();
 
     char* bitmap_start = reinterpret_cast<char*>(
         (reinterpret_cast<uint64_t>(_kernel_end) + 0xFFF) & ~0xFFFULL
@@ -62,9 +164,7 @@ void kernel_init(int magic, multiboot_info_t* multiboot_info) {
     kernel_basic_info.pages_bitmap = bitmap_start;
     kernel_basic_info.pages_bitmap_size = PAGE_BITMAP_SIZE;
 
-    for (uint64_t i = 0; i < PAGE_BITMAP_SIZE; ++i) {
-        bitmap_start[i] = 0;
-    }
+    kmemset(bitmap_start, 0, PAGE_BITMAP_SIZE);
 
     kernel_basic_info.total_pages = 16ULL * 1024 * 1024 * 1024 / 4096;
 
@@ -92,14 +192,20 @@ void kernel_init(int magic, multiboot_info_t* multiboot_info) {
         kernel_basic_info.total_pages
     );
 
+    Lapic::init();
+    Fpu::init();
+    percpu_init(0);
 
     IDT::init();
     IDT::load();
-    timer_init(10);
-    scheduler.init();
+    timer_init(kernel_basic_info.timer_hz);
+    scheduler.init(kernel_basic_info.quantum);
+    scheduler.set_policy(static_cast<SchedPolicy>(kernel_basic_info.sched_policy));
     Keyboard::init();
+    Tty::init();
     enable_interrupts();
     initialize_syscalls();
+    syscall_profiling = kernel_basic_info.syscall_profiling;
 
     g_fs = new fs::FileSystem();
     if (!g_fs->is_formatted()) {
@@ -110,6 +216,7 @@ void kernel_init(int magic, multiboot_info_t* multiboot_info) {
         g_fs->format(disk_size);
     }
     g_fs->mount();
+    fs::DiskIO::enable_irq();
     uint32_t t;
     if (g_fs->read_file("buffer", g_framebuffer.raw_buffer(), 80 * 25 * 2, &t) != fs::Error::Ok) {
         g_fs->create_file("buffer");
@@ -117,20 +224,23 @@ void kernel_init(int magic, multiboot_info_t* multiboot_info) {
     }
 
     void* init_buf = kmalloc(MAX_INIT_SIZE);
-    if (init_buf && scheduler.process_count < Scheduler::MAX_PROCESSES) {
+    if (init_buf) {
         uint32_t init_size = 0;
-        fs::Error read_err = g_fs->read_file("init", init_buf, MAX_INIT_SIZE, &init_size);
+        fs::Error read_err = g_fs->read_file(kernel_basic_info.init_name, init_buf, MAX_INIT_SIZE, &init_size);
         if (read_err == fs::Error::Ok && init_size > 0) {
-            Process* proc = new Process();
-            if (proc->pml4 && proc->load_binary(init_buf, init_size, HEAP_START_VIRT)) {
+            Process* proc = process_pool.acquire();
+            if (proc->pml4 && proc->load_binary(init_buf, init_size, HEAP_START_VIRT)
+                && scheduler.add_process(*proc)) {
                 kfree(init_buf);
                 disable_interrupts();
-                scheduler.add_process(*proc);
+                kernel_lock.lock();
+                smp_init(kernel_basic_info.max_cpus);
                 Process* init_proc = scheduler.get_current();
-                process_restore_and_switch_to_ctx(&init_proc->context, init_proc->get_cr3());
+                scheduler.switch_to(nullptr, init_proc);
+                idle_main();
             } else {
                 kfree(init_buf);
-                delete proc;
+                process_pool.release(proc);
             }
         } else if (init_buf) {
             kfree(init_buf);
@@ -0,0 +1,83 @@
+#include "kmem.h"
+#include "types/cpu.h"
+
+namespace {
+
+constexpr uint32_t CPUID_EXT_FEATURES = 7;
+constexpr uint32_t CPUID_EXT_EBX_ERMS = 1u << 9;
+
+typedef void* (*copy_fn_t)(void*, const void*, size_t);
+typedef void* (*fill_fn_t)(void*, uint8_t, size_t);
+
+void* copy_erms(void* dst, const void* src, size_t n) {
+    void* ret = dst;
+    asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+    return ret;
+}
+
+void* copy_qwords(void* dst, const void* src, size_t n) {
+    void* ret = dst;
+    size_t words = n / 8;
+    size_t tail = n % 8;
+    asm volatile("rep movsq" : "+D"(dst), "+S"(src), "+c"(words) : : "memory");
+    asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(tail) : : "memory");
+    return ret;
+}
+
+void* fill_erms(void* dst, uint8_t value, size_t n) {
+    void* ret = dst;
+    asm volatile("rep stosb" : "+D"(dst), "+c"(n) : "a"(value) : "memory");
+    return ret;
+}
+
+void* fill_qwords(void* dst, uint8_t value, size_t n) {
+    void* ret = dst;
+    uint64_t pattern = static_cast<uint64_t>(value) * 0x0101010101010101ULL;
+    size_t words = n / 8;
+    size_t tail = n % 8;
+    asm volatile("rep stosq" : "+D"(dst), "+c"(words) : "a"(pattern) : "memory");
+    asm volatile("rep stosb" : "+D"(dst), "+c"(tail) : "a"(pattern) : "memory");
+    return ret;
+}
+
+copy_fn_t copy_impl = copy_qwords;
+fill_fn_t fill_impl = fill_qwords;
+
+}
+
+void kmem_init() {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(0, 0, eax, ebx, ecx, edx);
+    bool erms = false;
+    if (eax >= CPUID_EXT_FEATURES) {
+        cpuid(CPUID_EXT_FEATURES, 0, eax, ebx, ecx, edx);
+        erms = (ebx & CPUID_EXT_EBX_ERMS) != 0;
+    }
+    copy_impl = erms ? copy_erms : copy_qwords;
+    fill_impl = erms ? fill_erms : fill_qwords;
+}
+
+void* kmemcpy(void* dst, const void* src, size_t n) {
+    if (n == 0)
+        return dst;
+    return copy_impl(dst, src, n);
+}
+
+void* kmemmove(void* dst, const void* src, size_t n) {
+    if (n == 0 || dst == src)
+        return dst;
+    char* d = static_cast<char*>(dst);
+    const char* s = static_cast<const char*>(src);
+    if (d < s || d >= s + n)
+        return copy_impl(dst, src, n);
+    d += n - 1;
+    s += n - 1;
+    asm volatile("std\n\trep movsb\n\tcld" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
+    return dst;
+}
+
+void* kmemset(void* dst, uint8_t value, size_t n) {
+    if (n == 0)
+        return dst;
+    return fill_impl(dst, value, n);
+}
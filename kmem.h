@@ -0,0 +1,7 @@
+#pragma once
+#include "types/types.h"
+
+void kmem_init();
+void* kmemcpy(void* dst, const void* src, size_t n);
+void* kmemmove(void* dst, const void* src, size_t n);
+void* kmemset(void* dst, uint8_t value, size_t n);
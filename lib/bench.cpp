@@ -0,0 +1,264 @@
+#include "syscall.h"
+#include "out.h"
+#include "ring.h"
+#include "timepage.h"
+
+static constexpr int SWITCH_ROUNDS = 2000;
+static constexpr int SPAWN_ROUNDS = 50;
+static constexpr int WAKE_ROUNDS = 200;
+static constexpr int RING_ROUNDS = 100;
+static constexpr int CLOCK_ROUNDS = 1000;
+static constexpr int MAX_PROCS = 32;
+static constexpr uint64_t NO_VALUE = ~0ULL;
+
+struct sample {
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t total;
+};
+
+static inline uint64_t rdtsc() {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+static void sample_reset(sample& s) {
+    s.count = 0;
+    s.min = NO_VALUE;
+    s.max = 0;
+    s.total = 0;
+}
+
+static void sample_add(sample& s, uint64_t value) {
+    ++s.count;
+    s.total += value;
+    if (value < s.min)
+        s.min = value;
+    if (value > s.max)
+        s.max = value;
+}
+
+static bool streq(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+static uint64_t parse_uint(const char* s) {
+    uint64_t value = 0;
+    while (*s >= '0' && *s <= '9')
+        value = value * 10 + static_cast<uint64_t>(*s++ - '0');
+    return value;
+}
+
+static int append_str(char* buf, int pos, const char* s) {
+    while (*s)
+        buf[pos++] = *s++;
+    return pos;
+}
+
+static int append_uint(char* buf, int pos, uint64_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n > 0)
+        buf[pos++] = digits[--n];
+    return pos;
+}
+
+static int append_value(char* buf, int pos, uint64_t value) {
+    buf[pos++] = ' ';
+    if (value == NO_VALUE)
+        return append_str(buf, pos, "-");
+    return append_uint(buf, pos, value);
+}
+
+static void emit(const char* line, int len) {
+    sys_purr(line, static_cast<uint32_t>(len));
+    sys_meow(nullptr, line, static_cast<uint32_t>(len));
+}
+
+static void emit_tag(const char* tag, uint64_t value) {
+    char line[64];
+    int pos = append_str(line, 0, tag);
+    pos = append_value(line, pos, value);
+    line[pos++] = '\n';
+    emit(line, pos);
+}
+
+static void report(const char* name, uint64_t count, uint64_t min, uint64_t avg, uint64_t max) {
+    char line[128];
+    int pos = append_str(line, 0, "BENCH ");
+    pos = append_str(line, pos, name);
+    pos = append_value(line, pos, count);
+    pos = append_value(line, pos, min);
+    pos = append_value(line, pos, avg);
+    pos = append_value(line, pos, max);
+    line[pos++] = '\n';
+    emit(line, pos);
+}
+
+static void report_sample(const char* name, const sample& s) {
+    if (s.count == 0) {
+        report(name, 0, NO_VALUE, NO_VALUE, NO_VALUE);
+        return;
+    }
+    report(name, s.count, s.min, s.total / s.count, s.max);
+}
+
+static bool own_stats(uint64_t pid, proc_stats& out) {
+    proc_stats stats[MAX_PROCS];
+    int64_t count = sys_stats(stats, MAX_PROCS);
+    for (int64_t i = 0; i < count; ++i) {
+        if (stats[i].pid == pid) {
+            out = stats[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+static void bench_wakeup(uint64_t self, const clock_info& clock) {
+    uint64_t expected = clock.tsc_hz / clock.hz;
+    proc_stats before;
+    proc_stats after;
+    bool have_before = own_stats(self, before);
+    sample jitter;
+    sample_reset(jitter);
+    sys_nap(1);
+    uint64_t prev = rdtsc();
+    for (int i = 0; i < WAKE_ROUNDS; ++i) {
+        sys_nap(1);
+        uint64_t now = rdtsc();
+        uint64_t interval = now - prev;
+        sample_add(jitter, interval > expected ? interval - expected : expected - interval);
+        prev = now;
+    }
+    report_sample("nap_jitter", jitter);
+    if (!have_before || !own_stats(self, after))
+        return;
+    uint64_t wakeups = after.wakeups - before.wakeups;
+    uint64_t cycles = after.wake_latency_cycles - before.wake_latency_cycles;
+    report("wake_latency", wakeups, NO_VALUE, wakeups ? cycles / wakeups : NO_VALUE,
+        after.max_wake_latency_cycles);
+}
+
+static void bench_switch(uint64_t self) {
+    char cmd[64];
+    int pos = append_str(cmd, 0, "bench pong ");
+    pos = append_uint(cmd, pos, self);
+    cmd[pos] = '\0';
+    int64_t child = sys_play(cmd, 1);
+    if (child < 0) {
+        putstr("bench: spawn failed\n");
+        return;
+    }
+    sample s;
+    sample_reset(s);
+    sys_yield_to(static_cast<uint64_t>(child));
+    for (int i = 0; i < SWITCH_ROUNDS; ++i) {
+        uint64_t start = rdtsc();
+        if (sys_yield_to(static_cast<uint64_t>(child)) < 0)
+            continue;
+        sample_add(s, (rdtsc() - start) / 2);
+    }
+    sys_wait(static_cast<uint64_t>(child));
+    report_sample("yield_switch", s);
+}
+
+static void bench_spawn() {
+    sample s;
+    sample_reset(s);
+    for (int i = 0; i < SPAWN_ROUNDS; ++i) {
+        uint64_t start = rdtsc();
+        int64_t child = sys_play("bench exit", 1);
+        if (child < 0) {
+            putstr("bench: spawn failed\n");
+            return;
+        }
+        sys_wait(static_cast<uint64_t>(child));
+        sample_add(s, rdtsc() - start);
+    }
+    report_sample("spawn_wait", s);
+}
+
+static void bench_ring() {
+    ring_layout* ring = sys_ring();
+    if (!ring) {
+        putstr("bench: ring setup failed\n");
+        return;
+    }
+    sample direct;
+    sample batched;
+    sample_reset(direct);
+    sample_reset(batched);
+    for (int round = 0; round < RING_ROUNDS; ++round) {
+        uint64_t start = rdtsc();
+        for (int i = 0; i < RING_ENTRIES; ++i)
+            sys_self();
+        sample_add(direct, (rdtsc() - start) / RING_ENTRIES);
+
+        start = rdtsc();
+        for (int i = 0; i < RING_ENTRIES; ++i)
+            ring_queue(ring, SYS_SELF, 0, 0, 0, static_cast<uint64_t>(i));
+        ring_submit(ring);
+        ring_cqe cqe;
+        int reaped = 0;
+        while (ring_reap(ring, cqe))
+            ++reaped;
+        if (reaped == RING_ENTRIES)
+            sample_add(batched, (rdtsc() - start) / RING_ENTRIES);
+    }
+    report_sample("syscall_self", direct);
+    report_sample("ring_self", batched);
+}
+
+static void bench_clock() {
+    sample trap;
+    sample page;
+    sample_reset(trap);
+    sample_reset(page);
+    for (int i = 0; i < CLOCK_ROUNDS; ++i) {
+        uint64_t start = rdtsc();
+        sys_time();
+        sample_add(trap, rdtsc() - start);
+        start = rdtsc();
+        time_now_ns();
+        sample_add(page, rdtsc() - start);
+    }
+    report_sample("syscall_time", trap);
+    report_sample("page_time", page);
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && streq(argv[1], "exit"))
+        return 0;
+    if (argc >= 3 && streq(argv[1], "pong")) {
+        uint64_t parent = parse_uint(argv[2]);
+        while (sys_yield_to(parent) >= 0) {
+        }
+        return 0;
+    }
+    clock_info clock;
+    int64_t self = sys_self();
+    if (self < 0 || sys_clock(&clock) < 0 || clock.hz == 0) {
+        putstr("bench: clock failed\n");
+        sys_drop(1);
+    }
+    emit_tag("BENCH-TSC", clock.tsc_hz);
+    emit_tag("BENCH-HZ", clock.hz);
+    bench_wakeup(static_cast<uint64_t>(self), clock);
+    bench_switch(static_cast<uint64_t>(self));
+    bench_spawn();
+    bench_ring();
+    bench_clock();
+    emit_tag("BENCH-DONE", 0);
+    sys_drop(0);
+}
@@ -10,9 +10,11 @@ int main(int argc, char** argv) {
         putstr("list failed\n");
         sys_drop(1);
     }
+    const char* parts[64];
     for (int i = 0; i < n; ++i) {
-        putstr(names[i]);
-        putstr("\n");
+        parts[2 * i] = names[i];
+        parts[2 * i + 1] = "\n";
     }
+    putstrv(parts, static_cast<int>(n * 2));
     sys_drop(0);
 }
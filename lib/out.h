@@ -4,4 +4,21 @@ static void putstr(const char* s) {
     const char* p = s;
     while (*p) ++p;
     sys_meow(nullptr, s, static_cast<uint32_t>(p - s));
-}
\ No newline at end of file
+}
+
+static inline void putstrv(const char* const* parts, int count) {
+    iovec iov[MAX_IOV];
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        const char* p = parts[i];
+        while (*p) ++p;
+        iov[n].base = parts[i];
+        iov[n].len = static_cast<uint64_t>(p - parts[i]);
+        if (++n == MAX_IOV) {
+            sys_meowv(nullptr, iov, static_cast<uint32_t>(n));
+            n = 0;
+        }
+    }
+    if (n > 0)
+        sys_meowv(nullptr, iov, static_cast<uint32_t>(n));
+}
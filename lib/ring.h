@@ -0,0 +1,47 @@
+#pragma once
+#include "syscall.h"
+
+static inline bool ring_queue(ring_layout* ring, uint64_t opcode, uint64_t a0, uint64_t a1,
+    uint64_t a2, uint64_t user_data) {
+    uint32_t tail = ring->header.sq_tail;
+    if (tail - __atomic_load_n(&ring->header.sq_head, __ATOMIC_ACQUIRE) >= RING_ENTRIES)
+        return false;
+    ring_sqe& sqe = ring->sq[tail & (RING_ENTRIES - 1)];
+    sqe.opcode = opcode;
+    sqe.args[0] = a0;
+    sqe.args[1] = a1;
+    sqe.args[2] = a2;
+    sqe.args[3] = 0;
+    sqe.args[4] = 0;
+    sqe.user_data = user_data;
+    __atomic_store_n(&ring->header.sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline uint32_t ring_pending(const ring_layout* ring) {
+    return ring->header.sq_tail - __atomic_load_n(&ring->header.sq_head, __ATOMIC_ACQUIRE);
+}
+
+static inline int64_t ring_submit(ring_layout* ring) {
+    uint32_t pending = ring_pending(ring);
+    if (pending == 0)
+        return 0;
+    return sys_submit(pending);
+}
+
+static inline bool ring_reap(ring_layout* ring, ring_cqe& out) {
+    uint32_t head = ring->header.cq_head;
+    if (head == __atomic_load_n(&ring->header.cq_tail, __ATOMIC_ACQUIRE))
+        return false;
+    out = ring->cq[head & (RING_ENTRIES - 1)];
+    __atomic_store_n(&ring->header.cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline bool ring_meow(ring_layout* ring, const char* s, uint64_t user_data) {
+    const char* p = s;
+    while (*p)
+        ++p;
+    return ring_queue(ring, SYS_MEOW, 0, reinterpret_cast<uint64_t>(s),
+        static_cast<uint64_t>(p - s), user_data);
+}
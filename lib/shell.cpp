@@ -10,28 +10,9 @@ static const char prompt[] = "meow here: ";
 
 
 static int readline(char* buf, uint32_t max_size) {
-    uint32_t n = 0;
-    while (n + 1 < max_size) {
-        char c = 0;
-        int64_t got = sys_pet(nullptr, &c, 1);
-        if (got < 0) return -1;
-        if (got == 0) {
-            continue;
-        }
-        if (c == '\b') {
-            if (n > 0) {
-                n--;
-                sys_meow(nullptr, &c, 1);
-            }
-            continue;
-        }
-        if (c == '\r') c = '\n';
-        buf[n++] = c;
-        sys_meow(nullptr, &c, 1);
-        if (c == '\n')
-            break;
-    }
-    return static_cast<int>(n);
+    int64_t got = sys_pet(nullptr, buf, max_size - 1);
+    if (got < 0) return -1;
+    return static_cast<int>(got);
 }
 
 void process_command(const char* line) {
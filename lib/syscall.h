@@ -10,6 +10,131 @@
 #define SYS_DROP  6
 #define SYS_LIST  7
 #define SYS_WAIT  8
+#define SYS_SLICE 9
+#define SYS_CLOCK 10
+#define SYS_NAP   11
+#define SYS_YIELD 12
+#define SYS_STATS 13
+#define SYS_PURR  14
+#define SYS_SELF  15
+#define SYS_DEADLINE 16
+#define SYS_PROFILE 17
+#define SYS_RING  18
+#define SYS_SUBMIT 19
+#define SYS_MEOWV 20
+#define SYS_PETV  21
+#define SYS_TTY   22
+#define SYS_POLL  23
+
+#define TTY_CANONICAL 0
+#define TTY_RAW       1
+
+#define SYSCALL_NAME_LEN 16
+#define SYSCALL_HISTOGRAM_BUCKETS 16
+#define SYSCALL_HISTOGRAM_SHIFT 8
+#define SYSCALL_MAX_ARGS 5
+#define RING_ENTRIES 64
+#define TIME_PAGE_ADDR 0x40010000ULL
+#define MAX_IOV 16
+#define MAX_POLL 16
+
+#define POLL_KEYBOARD 1
+#define POLL_CHILD    2
+#define POLL_TIMER    3
+#define POLL_NOWAIT   1
+
+struct clock_info {
+    uint64_t hz;
+    uint64_t ticks;
+    uint64_t tick_handler_calls;
+    uint64_t tick_handler_cycles;
+    uint64_t tick_handler_max_cycles;
+    uint64_t idle_entries;
+    uint64_t idle_cycles;
+    uint64_t tsc_hz;
+};
+
+struct proc_stats {
+    uint64_t pid;
+    uint64_t state;
+    uint64_t priority;
+    uint64_t run_ticks;
+    uint64_t run_cycles;
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+    uint64_t blocked_ticks;
+    uint64_t wakeups;
+    uint64_t wake_latency_cycles;
+    uint64_t max_wake_latency_cycles;
+    uint64_t deadline_misses;
+    uint64_t rt_throttles;
+};
+
+struct deadline_params {
+    uint64_t period;
+    uint64_t budget;
+    uint64_t deadline;
+};
+
+struct iovec {
+    const void* base;
+    uint64_t len;
+};
+
+struct poll_event {
+    uint32_t source;
+    uint32_t ready;
+    uint64_t arg;
+};
+
+struct time_page {
+    uint32_t seq;
+    uint32_t hz;
+    uint64_t ticks;
+    uint64_t tick_tsc;
+    uint64_t tsc_hz;
+    uint64_t tsc_per_tick;
+    uint64_t boot_tsc;
+};
+
+struct ring_header {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    uint32_t entries;
+    uint32_t reserved;
+    uint64_t rejected;
+    uint64_t pad[4];
+};
+
+struct ring_sqe {
+    uint64_t opcode;
+    uint64_t args[SYSCALL_MAX_ARGS];
+    uint64_t user_data;
+};
+
+struct ring_cqe {
+    uint64_t user_data;
+    int64_t result;
+};
+
+struct ring_layout {
+    ring_header header;
+    ring_sqe sq[RING_ENTRIES];
+    ring_cqe cq[RING_ENTRIES];
+};
+
+struct syscall_profile {
+    char name[SYSCALL_NAME_LEN];
+    uint64_t number;
+    uint64_t arity;
+    uint64_t calls;
+    uint64_t completed;
+    uint64_t total_cycles;
+    uint64_t max_cycles;
+    uint64_t histogram[SYSCALL_HISTOGRAM_BUCKETS];
+};
 
 static inline uint64_t syscall0(uint64_t num) {
     uint64_t ret;
@@ -68,6 +193,31 @@ static inline int64_t sys_meow(const char* filename, const void* buf, uint32_t s
         static_cast<uint64_t>(size)));
 }
 
+static inline int64_t sys_meowv(const char* filename, const iovec* iov, uint32_t count) {
+    return static_cast<int64_t>(syscall3(SYS_MEOWV,
+        reinterpret_cast<uint64_t>(filename),
+        reinterpret_cast<uint64_t>(iov),
+        static_cast<uint64_t>(count)));
+}
+
+static inline int64_t sys_petv(const char* filename, const iovec* iov, uint32_t count) {
+    return static_cast<int64_t>(syscall3(SYS_PETV,
+        reinterpret_cast<uint64_t>(filename),
+        reinterpret_cast<uint64_t>(iov),
+        static_cast<uint64_t>(count)));
+}
+
+static inline int64_t sys_tty(uint64_t mode) {
+    return static_cast<int64_t>(syscall1(SYS_TTY, mode));
+}
+
+static inline int64_t sys_poll(poll_event* events, uint32_t count, uint64_t flags) {
+    return static_cast<int64_t>(syscall3(SYS_POLL,
+        reinterpret_cast<uint64_t>(events),
+        static_cast<uint64_t>(count),
+        flags));
+}
+
 static inline void sys_drop(int status) {
     (void)syscall1(SYS_DROP, static_cast<uint64_t>(status));
 }
@@ -84,3 +234,61 @@ static inline int64_t sys_wait(uint64_t pid) {
     return static_cast<int64_t>(syscall1(SYS_WAIT, pid));
 }
 
+static inline int64_t sys_slice(uint64_t pid, uint64_t ticks) {
+    return static_cast<int64_t>(syscall2(SYS_SLICE, pid, ticks));
+}
+
+static inline int64_t sys_clock(clock_info* info) {
+    return static_cast<int64_t>(syscall1(SYS_CLOCK, reinterpret_cast<uint64_t>(info)));
+}
+
+static inline int64_t sys_nap(uint64_t ticks) {
+    return static_cast<int64_t>(syscall2(SYS_NAP, ticks, 0));
+}
+
+static inline int64_t sys_nap_until(uint64_t tick) {
+    return static_cast<int64_t>(syscall2(SYS_NAP, tick, 1));
+}
+
+static inline int64_t sys_yield() {
+    return static_cast<int64_t>(syscall1(SYS_YIELD, 0));
+}
+
+static inline int64_t sys_yield_to(uint64_t pid) {
+    return static_cast<int64_t>(syscall1(SYS_YIELD, pid));
+}
+
+static inline int64_t sys_stats(proc_stats* stats, int max_procs) {
+    return static_cast<int64_t>(syscall2(SYS_STATS,
+        reinterpret_cast<uint64_t>(stats),
+        static_cast<uint64_t>(max_procs)));
+}
+
+static inline int64_t sys_purr(const void* buf, uint32_t size) {
+    return static_cast<int64_t>(syscall2(SYS_PURR,
+        reinterpret_cast<uint64_t>(buf),
+        static_cast<uint64_t>(size)));
+}
+
+static inline int64_t sys_self() {
+    return static_cast<int64_t>(syscall0(SYS_SELF));
+}
+
+static inline int64_t sys_deadline(uint64_t pid, const deadline_params* params) {
+    return static_cast<int64_t>(syscall2(SYS_DEADLINE, pid, reinterpret_cast<uint64_t>(params)));
+}
+
+static inline int64_t sys_profile(syscall_profile* profiles, int max_entries) {
+    return static_cast<int64_t>(syscall2(SYS_PROFILE,
+        reinterpret_cast<uint64_t>(profiles),
+        static_cast<uint64_t>(max_entries)));
+}
+
+static inline ring_layout* sys_ring() {
+    int64_t addr = static_cast<int64_t>(syscall0(SYS_RING));
+    return addr < 0 ? nullptr : reinterpret_cast<ring_layout*>(addr);
+}
+
+static inline int64_t sys_submit(uint32_t max_entries) {
+    return static_cast<int64_t>(syscall1(SYS_SUBMIT, max_entries));
+}
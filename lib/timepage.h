@@ -0,0 +1,65 @@
+#pragma once
+#include "syscall.h"
+
+struct time_snapshot {
+    uint64_t hz;
+    uint64_t ticks;
+    uint64_t tick_tsc;
+    uint64_t tsc_hz;
+    uint64_t tsc_per_tick;
+    uint64_t boot_tsc;
+};
+
+static inline const volatile time_page* time_page_map() {
+    return reinterpret_cast<const volatile time_page*>(TIME_PAGE_ADDR);
+}
+
+static inline uint64_t time_rdtsc() {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+static inline void time_read(time_snapshot& out) {
+    const volatile time_page* page = time_page_map();
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+        out.hz = page->hz;
+        out.ticks = page->ticks;
+        out.tick_tsc = page->tick_tsc;
+        out.tsc_hz = page->tsc_hz;
+        out.tsc_per_tick = page->tsc_per_tick;
+        out.boot_tsc = page->boot_tsc;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) == seq)
+            return;
+    }
+}
+
+static inline uint64_t time_ticks() {
+    time_snapshot snap;
+    time_read(snap);
+    return snap.ticks;
+}
+
+static inline uint64_t time_now_ns() {
+    time_snapshot snap;
+    time_read(snap);
+    if (snap.hz == 0 || snap.tsc_hz == 0)
+        return 0;
+    uint64_t since_tick = time_rdtsc() - snap.tick_tsc;
+    if (since_tick > snap.tsc_per_tick)
+        since_tick = snap.tsc_per_tick;
+    uint64_t ns = snap.ticks / snap.hz * 1000000000ULL + snap.ticks % snap.hz * 1000000000ULL / snap.hz;
+    return ns + since_tick * 1000000000ULL / snap.tsc_hz;
+}
+
+static inline uint64_t time_tsc_to_ns(uint64_t cycles) {
+    time_snapshot snap;
+    time_read(snap);
+    if (snap.tsc_hz == 0)
+        return 0;
+    return cycles / snap.tsc_hz * 1000000000ULL + cycles % snap.tsc_hz * 1000000000ULL / snap.tsc_hz;
+}
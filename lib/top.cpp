@@ -0,0 +1,69 @@
+#include "syscall.h"
+#include "out.h"
+
+static constexpr int MAX_PROCS = 32;
+
+static void put_uint(uint64_t value, int width) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    char buf[48];
+    int pos = 0;
+    while (pos < width - n && pos < 24)
+        buf[pos++] = ' ';
+    while (n > 0)
+        buf[pos++] = digits[--n];
+    buf[pos] = '\0';
+    putstr(buf);
+}
+
+static const proc_stats* find_pid(const proc_stats* stats, int64_t count, uint64_t pid) {
+    for (int64_t i = 0; i < count; ++i) {
+        if (stats[i].pid == pid)
+            return &stats[i];
+    }
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    clock_info clock;
+    if (sys_clock(&clock) < 0) {
+        putstr("top: clock failed\n");
+        sys_drop(1);
+    }
+    proc_stats before[MAX_PROCS];
+    proc_stats after[MAX_PROCS];
+    uint64_t start = clock.ticks;
+    int64_t n_before = sys_stats(before, MAX_PROCS);
+    sys_nap(clock.hz);
+    int64_t n_after = sys_stats(after, MAX_PROCS);
+    if (n_before < 0 || n_after < 0 || sys_clock(&clock) < 0) {
+        putstr("top: stats failed\n");
+        sys_drop(1);
+    }
+    uint64_t elapsed = clock.ticks - start;
+    if (elapsed == 0)
+        elapsed = 1;
+    putstr("  PID S PRI CPU%   TICKS  MCYCLES    VOL  INVOL BLOCKED\n");
+    for (int64_t i = 0; i < n_after; ++i) {
+        const proc_stats& p = after[i];
+        const proc_stats* prev = find_pid(before, n_before, p.pid);
+        uint64_t recent = prev ? p.run_ticks - prev->run_ticks : p.run_ticks;
+        put_uint(p.pid, 5);
+        putstr(p.state == 0 ? " R" : " B");
+        put_uint(p.priority, 4);
+        put_uint(recent * 100 / elapsed, 5);
+        put_uint(p.run_ticks, 8);
+        put_uint(p.run_cycles / 1000000, 9);
+        put_uint(p.voluntary_switches, 7);
+        put_uint(p.involuntary_switches, 7);
+        put_uint(p.blocked_ticks, 8);
+        putstr("\n");
+    }
+    sys_drop(0);
+}
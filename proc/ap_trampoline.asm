@@ -0,0 +1,102 @@
+global ap_trampoline_start
+global ap_trampoline_end
+global ap_long_mode
+extern pml4_table
+extern gdt_ptr_copy
+extern ap_main
+
+%define TRAMPOLINE_BASE 0x8000
+%define TRAMP(x) (TRAMPOLINE_BASE + (x) - ap_trampoline_start)
+%define MAX_CPUS 8
+%define AP_STACK_SHIFT 14
+
+section .text
+
+;  Real-mode entry, copied to TRAMPOLINE_BASE and started by SIPI
+[bits 16]
+ap_trampoline_start:
+    cli
+    cld
+    xor  ax, ax
+    mov  ds, ax
+    mov  es, ax
+    mov  ss, ax
+    lgdt [TRAMP(tramp_gdt_ptr)]
+    mov  eax, cr0
+    or   eax, 1                   ; Protection Enable
+    mov  cr0, eax
+    jmp  dword 0x08:TRAMP(tramp_protected)
+
+[bits 32]
+tramp_protected:
+    mov  ax, 0x10
+    mov  ds, ax
+    mov  es, ax
+    mov  ss, ax
+    mov  eax, cr4
+    bts  eax, 5                   ; PAE
+    mov  cr4, eax
+    mov  eax, pml4_table          ; Share the kernel page tables
+    mov  cr3, eax
+    mov  ecx, 0xC0000080
+    rdmsr
+    bts  eax, 8                   ; Long Mode Enable
+    wrmsr
+    mov  eax, cr0
+    bts  eax, 31                  ; Paging
+    mov  cr0, eax
+    jmp  0x18:TRAMP(tramp_long)
+
+[bits 64]
+tramp_long:
+    mov  rax, ap_long_mode        ; Leave low memory for the kernel image
+    jmp  rax
+
+align 8
+tramp_gdt:
+    dq 0                          ; null
+    dq 0x00CF9A000000FFFF         ; 0x08 32-bit code
+    dq 0x00CF92000000FFFF         ; 0x10 data
+    dq 0x00AF9A000000FFFF         ; 0x18 64-bit code
+tramp_gdt_ptr:
+    dw 4 * 8 - 1
+    dd TRAMP(tramp_gdt)
+ap_trampoline_end:
+
+;  Long-mode entry in the kernel image: switch to the kernel GDT and a private stack
+ap_long_mode:
+    lgdt [rel gdt_ptr_copy]
+    mov  ax, 0x10
+    mov  ds, ax
+    mov  es, ax
+    mov  fs, ax
+    mov  gs, ax
+    mov  ss, ax
+    push 0x08
+    lea  rax, [rel .reload_cs]
+    push rax
+    o64 retf
+.reload_cs:
+    mov  eax, 1
+    lock xadd [rel ap_next_index], eax   ; EAX = this CPU's index
+    cmp  eax, MAX_CPUS
+    jae  .park
+    mov  edi, eax
+    mov  rbx, rax
+    shl  rbx, AP_STACK_SHIFT
+    lea  rsp, [rel ap_stacks]
+    add  rsp, rbx                 ; Top of slot (index - 1)
+    xor  rbp, rbp
+    call ap_main
+.park:
+    cli
+    hlt
+    jmp  .park
+
+section .data
+align 4
+ap_next_index: dd 1
+
+section .bss
+align 16
+ap_stacks: resb (MAX_CPUS - 1) << AP_STACK_SHIFT
@@ -0,0 +1,190 @@
+#include "fpu.h"
+#include "percpu.h"
+#include "process.h"
+#include "heap.h"
+#include "kmem.h"
+#include "types/cpu.h"
+
+bool Fpu::xsave = false;
+bool Fpu::xsaveopt = false;
+uint64_t Fpu::xcr0 = 0;
+uint32_t Fpu::area_size = 512;
+
+namespace {
+
+constexpr uint64_t CR0_MP = 1ULL << 1;
+constexpr uint64_t CR0_EM = 1ULL << 2;
+constexpr uint64_t CR0_TS = 1ULL << 3;
+constexpr uint64_t CR0_NE = 1ULL << 5;
+constexpr uint64_t CR4_OSFXSR = 1ULL << 9;
+constexpr uint64_t CR4_OSXMMEXCPT = 1ULL << 10;
+constexpr uint64_t CR4_OSXSAVE = 1ULL << 18;
+constexpr uint32_t CPUID1_ECX_XSAVE = 1u << 26;
+constexpr uint32_t CPUID1_ECX_AVX = 1u << 28;
+constexpr uint32_t CPUIDD1_EAX_XSAVEOPT = 1u << 0;
+constexpr uint64_t XCR0_X87 = 1ULL << 0;
+constexpr uint64_t XCR0_SSE = 1ULL << 1;
+constexpr uint64_t XCR0_AVX = 1ULL << 2;
+constexpr uint16_t DEFAULT_FCW = 0x37F;
+constexpr uint32_t DEFAULT_MXCSR = 0x1F80;
+constexpr size_t FCW_OFFSET = 0;
+constexpr size_t MXCSR_OFFSET = 24;
+
+inline uint64_t read_cr0() {
+    uint64_t value;
+    asm volatile("mov %%cr0, %0" : "=r"(value));
+    return value;
+}
+
+inline void write_cr0(uint64_t value) {
+    asm volatile("mov %0, %%cr0" : : "r"(value) : "memory");
+}
+
+inline uint64_t read_cr4() {
+    uint64_t value;
+    asm volatile("mov %%cr4, %0" : "=r"(value));
+    return value;
+}
+
+inline void write_cr4(uint64_t value) {
+    asm volatile("mov %0, %%cr4" : : "r"(value) : "memory");
+}
+
+inline void clts() {
+    asm volatile("clts" : : : "memory");
+}
+
+inline void stts() {
+    write_cr0(read_cr0() | CR0_TS);
+}
+
+inline void xsetbv(uint32_t index, uint64_t value) {
+    asm volatile("xsetbv" : : "c"(index), "a"(static_cast<uint32_t>(value)),
+        "d"(static_cast<uint32_t>(value >> 32)));
+}
+
+}
+
+void Fpu::init() {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, eax, ebx, ecx, edx);
+    if (!(ecx & CPUID1_ECX_XSAVE))
+        return;
+    xsave = true;
+    xcr0 = XCR0_X87 | XCR0_SSE;
+    if (ecx & CPUID1_ECX_AVX)
+        xcr0 |= XCR0_AVX;
+    cpuid(0xD, 1, eax, ebx, ecx, edx);
+    xsaveopt = (eax & CPUIDD1_EAX_XSAVEOPT) != 0;
+}
+
+void Fpu::init_cpu() {
+    write_cr0((read_cr0() & ~CR0_EM) | CR0_MP | CR0_NE);
+    uint64_t cr4 = read_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT;
+    if (xsave)
+        cr4 |= CR4_OSXSAVE;
+    write_cr4(cr4);
+    if (xsave) {
+        xsetbv(0, xcr0);
+        uint32_t eax, ebx, ecx, edx;
+        cpuid(0xD, 0, eax, ebx, ecx, edx);
+        if (ebx > area_size)
+            area_size = ebx;
+    }
+    asm volatile("fninit");
+    stts();
+}
+
+bool Fpu::allocate(Process& proc) {
+    proc.fpu_block = static_cast<uint8_t*>(kmalloc(area_size + AREA_ALIGN));
+    if (!proc.fpu_block)
+        return false;
+    uint64_t aligned = (reinterpret_cast<uint64_t>(proc.fpu_block) + AREA_ALIGN - 1) & ~static_cast<uint64_t>(AREA_ALIGN - 1);
+    proc.fpu_area = reinterpret_cast<uint8_t*>(aligned);
+    reset_area(proc);
+    return true;
+}
+
+void Fpu::reset_area(Process& proc) {
+    kmemset(proc.fpu_area, 0, area_size);
+    *reinterpret_cast<uint16_t*>(proc.fpu_area + FCW_OFFSET) = DEFAULT_FCW;
+    *reinterpret_cast<uint32_t*>(proc.fpu_area + MXCSR_OFFSET) = DEFAULT_MXCSR;
+}
+
+void Fpu::save(Process& proc) {
+    uint32_t low = static_cast<uint32_t>(xcr0);
+    uint32_t high = static_cast<uint32_t>(xcr0 >> 32);
+    if (xsaveopt)
+        asm volatile("xsaveopt64 (%0)" : : "r"(proc.fpu_area), "a"(low), "d"(high) : "memory");
+    else if (xsave)
+        asm volatile("xsave64 (%0)" : : "r"(proc.fpu_area), "a"(low), "d"(high) : "memory");
+    else
+        asm volatile("fxsave64 (%0)" : : "r"(proc.fpu_area) : "memory");
+}
+
+void Fpu::restore(Process& proc) {
+    uint32_t low = static_cast<uint32_t>(xcr0);
+    uint32_t high = static_cast<uint32_t>(xcr0 >> 32);
+    if (xsave)
+        asm volatile("xrstor64 (%0)" : : "r"(proc.fpu_area), "a"(low), "d"(high) : "memory");
+    else
+        asm volatile("fxrstor64 (%0)" : : "r"(proc.fpu_area) : "memory");
+}
+
+void Fpu::switch_to(PerCpu& cpu, Process* prev, Process* next) {
+    if (prev && cpu.fpu_active && cpu.fpu_owner == prev)
+        save(*prev);
+    if (next && cpu.fpu_owner == next && next->fpu_cpu == cpu.index) {
+        if (!cpu.fpu_active)
+            clts();
+        cpu.fpu_active = true;
+        return;
+    }
+    if (cpu.fpu_active)
+        stts();
+    cpu.fpu_active = false;
+}
+
+void Fpu::handle_trap() {
+    PerCpu& cpu = this_cpu();
+    clts();
+    cpu.fpu_active = true;
+    Process* proc = cpu.current;
+    if (!proc) {
+        asm volatile("fninit");
+        cpu.fpu_owner = nullptr;
+        return;
+    }
+    if (cpu.fpu_owner == proc && proc->fpu_cpu == cpu.index)
+        return;
+    if (!proc->fpu_area && !allocate(*proc)) {
+        asm volatile("fninit");
+        cpu.fpu_owner = nullptr;
+        return;
+    }
+    restore(*proc);
+    cpu.fpu_owner = proc;
+    proc->fpu_cpu = cpu.index;
+}
+
+void Fpu::forget(Process& proc) {
+    for (size_t i = 0; i < MAX_CPUS; ++i) {
+        if (cpus[i].fpu_owner == &proc)
+            cpus[i].fpu_owner = nullptr;
+    }
+    if (proc.fpu_area)
+        reset_area(proc);
+    PerCpu& cpu = this_cpu();
+    if (cpu.current == &proc && cpu.fpu_active) {
+        stts();
+        cpu.fpu_active = false;
+    }
+}
+
+void Fpu::free_area(Process& proc) {
+    if (!proc.fpu_block)
+        return;
+    kfree(proc.fpu_block);
+    proc.fpu_block = nullptr;
+    proc.fpu_area = nullptr;
+}
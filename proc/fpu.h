@@ -0,0 +1,29 @@
+#pragma once
+#include "types/types.h"
+
+class Process;
+struct PerCpu;
+
+class Fpu {
+private:
+    static bool xsave;
+    static bool xsaveopt;
+    static uint64_t xcr0;
+    static uint32_t area_size;
+
+    static bool allocate(Process& proc);
+    static void reset_area(Process& proc);
+    static void save(Process& proc);
+    static void restore(Process& proc);
+
+public:
+    static constexpr uint8_t TRAP_VECTOR = 7;
+    static constexpr uint32_t AREA_ALIGN = 64;
+
+    static void init();
+    static void init_cpu();
+    static void switch_to(PerCpu& cpu, Process* prev, Process* next);
+    static void handle_trap();
+    static void forget(Process& proc);
+    static void free_area(Process& proc);
+};
@@ -0,0 +1,57 @@
+#include "idle.h"
+#include "percpu.h"
+#include "process.h"
+#include "process_pool.h"
+#include "scheduler.h"
+#include "spinlock.h"
+#include "syscall_handler.h"
+#include "drivers/lapic.h"
+#include "types/kernel_info.h"
+
+IdleStats idle_stats;
+
+namespace {
+
+uint64_t enter_tsc[MAX_CPUS];
+
+void idle_enter(PerCpu& cpu) {
+    cpu.idle = true;
+    enter_tsc[cpu.index] = rdtsc();
+    ++idle_stats.entries;
+}
+
+void idle_leave() {
+    PerCpu& cpu = this_cpu();
+    scheduler.idle_catch_up();
+    Process* next = scheduler.pick_next_runnable();
+    if (!next)
+        return;
+    idle_stats.cycles += rdtsc() - enter_tsc[cpu.index];
+    cpu.idle = false;
+    if (cpu.index != 0 && cpus[0].idle)
+        Lapic::send_ipi(cpus[0].apic_id, Lapic::RESCHEDULE_VECTOR);
+    scheduler.switch_to(nullptr, next);
+    idle_enter(this_cpu());
+}
+
+}
+
+void idle_main() {
+    idle_enter(this_cpu());
+    for (;;) {
+        if (scheduler.has_runnable())
+            idle_leave();
+        else if (process_pool.scrub_one())
+            ++idle_stats.scrubbed_stacks;
+        else
+            scheduler.idle_halt();
+    }
+}
+
+uint64_t idle_cr3() {
+    return reinterpret_cast<uint64_t>(kernel_basic_info.pml4_table);
+}
+
+bool idle_running() {
+    return this_cpu().idle;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "types/types.h"
+
+struct IdleStats {
+    uint64_t entries;
+    uint64_t cycles;
+    uint64_t scrubbed_stacks;
+};
+
+[[noreturn]] void idle_main();
+uint64_t idle_cr3();
+bool idle_running();
+
+extern IdleStats idle_stats;
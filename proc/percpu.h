@@ -0,0 +1,55 @@
+#pragma once
+#include "types/types.h"
+#include "run_queue.h"
+
+class Process;
+
+constexpr size_t MAX_CPUS = 8;
+constexpr size_t SCHED_LEVELS = 4;
+constexpr size_t PERCPU_KERNEL_STACK = 8;
+constexpr size_t PERCPU_USER_RSP = 16;
+constexpr size_t PERCPU_IN_SYSCALL = 24;
+constexpr size_t GDT_ENTRIES = 5;
+constexpr uint16_t TSS_SELECTOR = 0x18;
+
+struct Tss {
+    uint32_t reserved0;
+    uint64_t rsp0;
+    uint64_t rsp1;
+    uint64_t rsp2;
+    uint64_t reserved1;
+    uint64_t ist[7];
+    uint64_t reserved2;
+    uint16_t reserved3;
+    uint16_t iomap_base;
+} __attribute__((packed));
+
+struct PerCpu {
+    PerCpu* self;
+    uint64_t kernel_stack;
+    uint64_t user_rsp;
+    bool in_syscall;
+    bool online;
+    bool idle;
+    uint32_t index;
+    uint32_t apic_id;
+    Process* current;
+    Process* dead;
+    Process* fpu_owner;
+    bool fpu_active;
+    uint64_t idle_rsp;
+    uint64_t quantum;
+    RunQueue ready[SCHED_LEVELS];
+    uint64_t gdt[GDT_ENTRIES];
+    Tss tss;
+};
+
+extern PerCpu cpus[MAX_CPUS];
+
+void percpu_init(uint32_t index);
+
+inline PerCpu& this_cpu() {
+    PerCpu* self;
+    asm volatile("mov %%gs:0, %0" : "=r"(self));
+    return *self;
+}
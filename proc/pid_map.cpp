@@ -0,0 +1,85 @@
+#include "pid_map.h"
+#include "heap.h"
+#include "kmem.h"
+
+size_t PidMap::slot_for(uint64_t pid) const {
+    return static_cast<size_t>((pid * 0x9E3779B97F4A7C15ULL) >> 32) & (capacity - 1);
+}
+
+bool PidMap::grow() {
+    size_t new_capacity = capacity ? capacity * 2 : INITIAL_CAPACITY;
+    Slot* new_slots = static_cast<Slot*>(kmalloc(new_capacity * sizeof(Slot)));
+    if (!new_slots)
+        return false;
+    kmemset(new_slots, 0, new_capacity * sizeof(Slot));
+    Slot* old_slots = slots;
+    size_t old_capacity = capacity;
+    slots = new_slots;
+    capacity = new_capacity;
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].pid == 0)
+            continue;
+        size_t s = slot_for(old_slots[i].pid);
+        while (slots[s].pid != 0)
+            s = (s + 1) & (capacity - 1);
+        slots[s] = old_slots[i];
+    }
+    kfree(old_slots);
+    return true;
+}
+
+bool PidMap::insert(uint64_t pid, Process* proc) {
+    if (pid == 0)
+        return false;
+    if ((count + 1) * 2 > capacity && !grow())
+        return false;
+    size_t s = slot_for(pid);
+    while (slots[s].pid != 0) {
+        if (slots[s].pid == pid) {
+            slots[s].proc = proc;
+            return true;
+        }
+        s = (s + 1) & (capacity - 1);
+    }
+    slots[s].pid = pid;
+    slots[s].proc = proc;
+    ++count;
+    return true;
+}
+
+Process* PidMap::find(uint64_t pid) const {
+    if (pid == 0 || capacity == 0)
+        return nullptr;
+    for (size_t s = slot_for(pid); slots[s].pid != 0; s = (s + 1) & (capacity - 1)) {
+        if (slots[s].pid == pid)
+            return slots[s].proc;
+    }
+    return nullptr;
+}
+
+void PidMap::erase(uint64_t pid) {
+    if (pid == 0 || capacity == 0)
+        return;
+    size_t s = slot_for(pid);
+    while (slots[s].pid != pid) {
+        if (slots[s].pid == 0)
+            return;
+        s = (s + 1) & (capacity - 1);
+    }
+    size_t hole = s;
+    for (size_t next = (hole + 1) & (capacity - 1); slots[next].pid != 0; next = (next + 1) & (capacity - 1)) {
+        size_t home = slot_for(slots[next].pid);
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole].pid = 0;
+    slots[hole].proc = nullptr;
+    --count;
+}
+
+size_t PidMap::size() const {
+    return count;
+}
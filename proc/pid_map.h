@@ -0,0 +1,27 @@
+#pragma once
+#include "types/types.h"
+
+class Process;
+
+class PidMap {
+public:
+    bool insert(uint64_t pid, Process* proc);
+    Process* find(uint64_t pid) const;
+    void erase(uint64_t pid);
+    size_t size() const;
+
+private:
+    struct Slot {
+        uint64_t pid;
+        Process* proc;
+    };
+
+    static constexpr size_t INITIAL_CAPACITY = 32;
+
+    size_t slot_for(uint64_t pid) const;
+    bool grow();
+
+    Slot* slots = nullptr;
+    size_t capacity = 0;
+    size_t count = 0;
+};
@@ -1,5 +1,13 @@
 #include "process.h"
 #include "types/kernel_info.h"
+#include "kmem.h"
+#include "heap.h"
+#include "fpu.h"
+#include "syscall/syscall.h"
+#include "timer.h"
+#include "drivers/lapic.h"
+
+extern "C" void process_first_entry();
 
 namespace {
 
@@ -8,6 +16,8 @@ constexpr uint64_t IDENTITY_MAPPED_END = 32ULL * 1024 * 1024;
 
 constexpr uint64_t PTE_KERNEL = 0x03;
 constexpr uint64_t PTE_USER = 0x07;
+constexpr uint64_t PTE_USER_RO = 0x05;
+constexpr uint64_t PTE_MMIO = 0x1B;
 
 constexpr uint64_t STACK_PAGES = 4;
 constexpr uint64_t STACK_SIZE = STACK_PAGES * PAGE_SIZE;
@@ -35,8 +45,7 @@ uint64_t* get_or_alloc_table(uint64_t* entry, uint64_t flags) {
     uint64_t phys = virt_to_phys(page);
     *entry = phys | flags;
     uint64_t* table = reinterpret_cast<uint64_t*>(page);
-    for (uint64_t i = 0; i < 512; ++i)
-        table[i] = 0;
+    kmemset(table, 0, PAGE_SIZE);
     return table;
 }
 
@@ -68,6 +77,13 @@ void unmap_page(uint64_t* pml4, uint64_t vaddr) {
     pt[pt_i] = 0;
 }
 
+void flush_page(uint64_t* pml4, uint64_t vaddr) {
+    uint64_t cr3;
+    asm volatile("mov %%cr3, %0" : "=r"(cr3));
+    if ((cr3 & ~0xFFFULL) == virt_to_phys(pml4))
+        asm volatile("invlpg (%0)" : : "r"(vaddr) : "memory");
+}
+
 void release_tables(uint64_t* table, unsigned level) {
     if (level == 0) return;
     for (uint64_t i = 0; i < 512; ++i) {
@@ -105,6 +121,10 @@ uint64_t resolve_vaddr_to_phys(uint64_t* pml4, uint64_t vaddr) {
 
 }
 
+bool map_mmio_page(uint64_t* pml4, uint64_t phys) {
+    return map_page(pml4, phys, phys, PTE_MMIO);
+}
+
 uint64_t Process::next_pid = 1;
 
 void MemoryMapping::add_region(uint64_t base, uint64_t size, uint8_t permissions) {
@@ -115,14 +135,14 @@ void MemoryMapping::add_region(uint64_t base, uint64_t size, uint8_t permissions
     ++count;
 }
 
-Process::Process() : state(ProcessState::Runnable), wait_queue_next(nullptr), exit_wait_head(nullptr), exit_wait_next(nullptr), pml4(nullptr), mapped_pages(0), heap_start(HEAP_START_VIRT), heap_end(HEAP_START_VIRT), stack_top(0), stack_size(0), pid(0) {
-    context = {};
+Process::Process() : kernel_stack(nullptr), kernel_rsp(0), fpu_block(nullptr), fpu_area(nullptr), fpu_cpu(0), ring_block(nullptr), ring(nullptr), state(ProcessState::Runnable), run_next(nullptr), run_prev(nullptr), run_queue(nullptr), pml4(nullptr), mapped_pages(0), heap_start(HEAP_START_VIRT), heap_end(HEAP_START_VIRT), stack_top(0), stack_size(0), pid(0), table_index(0), cpu(0), time_slice(0), priority(0) {
+    kernel_stack = static_cast<uint8_t*>(kmalloc(KERNEL_STACK_SIZE));
+    if (!kernel_stack) return;
     void* pml4_page = get_orchestrator().get_page();
     if (!pml4_page) return;
     get_orchestrator().set_page(pml4_page);
     pml4 = reinterpret_cast<uint64_t*>(pml4_page);
-    for (uint64_t i = 0; i < 512; ++i)
-        pml4[i] = 0;
+    kmemset(pml4, 0, PAGE_SIZE);
 
     map_kernel_memory();
 
@@ -139,21 +159,105 @@ Process::Process() : state(ProcessState::Runnable), wait_queue_next(nullptr), ex
 
     stack_top = STACK_TOP_VIRT;
     stack_size = STACK_SIZE;
-    context.rsp = stack_top;
-    context.ss = 0x10;
-    context.rip = 0;
-    context.cs = 0x08;
-    context.rflags = 0x202;
+    init_context();
     pid = next_pid++;
 }
 
 Process::~Process() {
+    Fpu::free_area(*this);
+    if (kernel_stack) {
+        kfree(kernel_stack);
+        kernel_stack = nullptr;
+    }
     if (!pml4) return;
+    release_image();
+    release_stack();
     release_pml4_hierarchy(pml4);
     get_orchestrator().release_page(pml4);
     pml4 = nullptr;
 }
 
+void Process::init_context() {
+    set_user_entry(0, stack_top);
+    SwitchFrame* frame = reinterpret_cast<SwitchFrame*>(syscall_frame()) - 1;
+    *frame = {};
+    frame->ret = reinterpret_cast<uint64_t>(&process_first_entry);
+    kernel_rsp = reinterpret_cast<uint64_t>(frame);
+}
+
+uint64_t Process::kernel_stack_top() const {
+    return (reinterpret_cast<uint64_t>(kernel_stack) + KERNEL_STACK_SIZE) & ~15ULL;
+}
+
+SyscallFrame* Process::syscall_frame() const {
+    return reinterpret_cast<SyscallFrame*>(kernel_stack_top()) - 1;
+}
+
+void Process::set_user_entry(uint64_t rip, uint64_t rsp) {
+    SyscallFrame* frame = syscall_frame();
+    *frame = {};
+    frame->rflags = 0x202;
+    frame->rip = rip;
+    frame->rsp = rsp;
+}
+
+void Process::set_user_stack(uint64_t rsp) {
+    syscall_frame()->rsp = rsp;
+}
+
+void Process::reset() {
+    state = ProcessState::Runnable;
+    run_next = nullptr;
+    run_prev = nullptr;
+    run_queue = nullptr;
+    heap_end = heap_start;
+    time_slice = 0;
+    priority = 0;
+    stats = {};
+    rt = {};
+    init_context();
+    pid = next_pid++;
+}
+
+void Process::release_image() {
+    if (!pml4) return;
+    release_ring();
+    for (uint64_t vaddr = heap_start; vaddr < heap_end; vaddr += PAGE_SIZE) {
+        uint64_t phys = resolve_vaddr_to_phys(pml4, vaddr);
+        if (!phys) continue;
+        unmap_page(pml4, vaddr);
+        flush_page(pml4, vaddr);
+        get_orchestrator().release_page(reinterpret_cast<void*>(phys));
+        --mapped_pages;
+    }
+    heap_end = heap_start;
+    size_t kept = 0;
+    for (size_t i = 0; i < memory_mapping.count; ++i) {
+        if (memory_mapping.regions[i].base >= heap_start)
+            continue;
+        memory_mapping.regions[kept++] = memory_mapping.regions[i];
+    }
+    memory_mapping.count = kept;
+}
+
+void Process::scrub_stack() {
+    if (!pml4) return;
+    for (uint64_t i = 0; i < STACK_PAGES; ++i) {
+        uint64_t phys = resolve_vaddr_to_phys(pml4, STACK_BASE_VIRT + i * PAGE_SIZE);
+        if (phys)
+            kmemset(reinterpret_cast<void*>(phys), 0, PAGE_SIZE);
+    }
+}
+
+void Process::release_stack() {
+    for (uint64_t i = 0; i < mapped_pages && i < STACK_PAGES; ++i) {
+        uint64_t vaddr = STACK_BASE_VIRT + i * PAGE_SIZE;
+        uint64_t phys = resolve_vaddr_to_phys(pml4, vaddr);
+        if (phys)
+            get_orchestrator().release_page(reinterpret_cast<void*>(phys));
+    }
+}
+
 void Process::map_kernel_memory() {
     uint64_t kernel_start = reinterpret_cast<uint64_t>(_kernel_start);
     uint64_t kernel_end = reinterpret_cast<uint64_t>(_kernel_end);
@@ -163,22 +267,15 @@ void Process::map_kernel_memory() {
             return;
     }
     memory_mapping.add_region(0, map_end, static_cast<uint8_t>(PTE_KERNEL));
+    map_page(pml4, TIME_PAGE_VIRT, timer_page_phys(), PTE_USER_RO);
+    if (Lapic::available())
+        map_mmio_page(pml4, Lapic::base());
 }
 
 uint64_t Process::get_cr3() const {
     return virt_to_phys(pml4);
 }
 
-void Process::switch_to() {
-    (void)this;
-}
-
-extern "C" void process_switch_to_asm(cpu_context_t* from, cpu_context_t* to, uint64_t new_cr3);
-
-void Process::switch_to(Process& from, Process& to) {
-    process_switch_to_asm(&from.context, &to.context, to.get_cr3());
-}
-
 uint64_t Process::brk(uint64_t addr) {
     if (addr < heap_start)
         return heap_end;
@@ -208,6 +305,8 @@ int64_t Process::sbrk_pages(int64_t n_pages) {
 
     if (n_pages > 0) {
         for (int64_t i = 0; i < n_pages; ++i) {
+            if (heap_end >= RING_VIRT)
+                return -1;
             void* phys_page = get_orchestrator().get_page();
             if (!phys_page)
                 return -1;
@@ -226,6 +325,7 @@ int64_t Process::sbrk_pages(int64_t n_pages) {
                 break;
             heap_end -= PAGE_SIZE;
             unmap_page(pml4, heap_end);
+            flush_page(pml4, heap_end);
             --mapped_pages;
         }
     }
@@ -245,12 +345,9 @@ bool Process::load_binary(const void* data, uint32_t size, uint64_t entry_point)
         get_orchestrator().set_page(phys_page);
         uint32_t chunk = (i + 1) * PAGE_SIZE <= size ? PAGE_SIZE : (size - i * PAGE_SIZE);
         char* dst = static_cast<char*>(phys_page);
-        for (uint32_t j = 0; j < chunk; ++j)
-            dst[j] = src[i * PAGE_SIZE + j];
-        if (chunk < PAGE_SIZE) {
-            for (uint32_t j = chunk; j < PAGE_SIZE; ++j)
-                dst[j] = 0;
-        }
+        kmemcpy(dst, src + i * PAGE_SIZE, chunk);
+        if (chunk < PAGE_SIZE)
+            kmemset(dst + chunk, 0, PAGE_SIZE - chunk);
         if (!map_page(pml4, vaddr, virt_to_phys(phys_page), PTE_USER)) {
             get_orchestrator().release_page(phys_page);
             return false;
@@ -260,11 +357,48 @@ bool Process::load_binary(const void* data, uint32_t size, uint64_t entry_point)
         ++mapped_pages;
     }
     memory_mapping.add_region(heap_start, n_pages * PAGE_SIZE, static_cast<uint8_t>(PTE_USER));
-    context.rip = entry_point;
-    context.rsp = stack_top;
+    set_user_entry(entry_point, stack_top);
     return true;
 }
 
+uint64_t Process::setup_ring() {
+    if (ring)
+        return RING_VIRT;
+    if (!pml4)
+        return 0;
+    constexpr uint64_t ring_size = RING_PAGES * PAGE_SIZE;
+    ring_block = static_cast<uint8_t*>(kmalloc(ring_size + PAGE_SIZE));
+    if (!ring_block)
+        return 0;
+    uint64_t base = (reinterpret_cast<uint64_t>(ring_block) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    kmemset(reinterpret_cast<void*>(base), 0, ring_size);
+    for (uint64_t i = 0; i < RING_PAGES; ++i) {
+        if (!map_page(pml4, RING_VIRT + i * PAGE_SIZE, base + i * PAGE_SIZE, PTE_USER)) {
+            for (uint64_t j = 0; j < i; ++j)
+                unmap_page(pml4, RING_VIRT + j * PAGE_SIZE);
+            kfree(ring_block);
+            ring_block = nullptr;
+            return 0;
+        }
+    }
+    ring = reinterpret_cast<Ring*>(base);
+    ring->header.entries = RING_ENTRIES;
+    memory_mapping.add_region(RING_VIRT, ring_size, static_cast<uint8_t>(PTE_USER));
+    return RING_VIRT;
+}
+
+void Process::release_ring() {
+    if (!ring)
+        return;
+    for (uint64_t i = 0; i < RING_PAGES; ++i) {
+        unmap_page(pml4, RING_VIRT + i * PAGE_SIZE);
+        flush_page(pml4, RING_VIRT + i * PAGE_SIZE);
+    }
+    kfree(ring_block);
+    ring_block = nullptr;
+    ring = nullptr;
+}
+
 bool Process::write_at(uint64_t vaddr, const void* data, size_t len) {
     if (!pml4 || !data)
         return false;
@@ -277,9 +411,7 @@ bool Process::write_at(uint64_t vaddr, const void* data, size_t len) {
         size_t chunk = static_cast<size_t>(PAGE_SIZE - page_off);
         if (chunk > len)
             chunk = len;
-        char* dst = reinterpret_cast<char*>(phys);
-        for (size_t i = 0; i < chunk; ++i)
-            dst[i] = src[i];
+        kmemcpy(reinterpret_cast<void*>(phys), src, chunk);
         vaddr += chunk;
         src += chunk;
         len -= chunk;
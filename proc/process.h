@@ -2,6 +2,13 @@
 #include "types/types.h"
 #include "types/cpu.h"
 #include "page_orchestrator.h"
+#include "timer_queue.h"
+#include "wait_queue.h"
+
+class RunQueue;
+struct Ring;
+
+bool map_mmio_page(uint64_t* pml4, uint64_t phys);
 
 enum class ProcessState { Runnable, Blocked };
 
@@ -20,16 +27,70 @@ public:
     void add_region(uint64_t base, uint64_t size, uint8_t permissions);
 };
 
+struct ProcessStats {
+    uint64_t run_ticks = 0;
+    uint64_t run_cycles = 0;
+    uint64_t run_start_tsc = 0;
+    uint64_t voluntary_switches = 0;
+    uint64_t involuntary_switches = 0;
+    uint64_t blocked_ticks = 0;
+    uint64_t blocked_since = 0;
+    uint64_t wake_tsc = 0;
+    uint64_t wakeups = 0;
+    uint64_t wake_latency_cycles = 0;
+    uint64_t max_wake_latency_cycles = 0;
+};
+
+struct SyscallFrame {
+    uint64_t pad;
+    uint64_t r15;
+    uint64_t r14;
+    uint64_t r13;
+    uint64_t r12;
+    uint64_t rbx;
+    uint64_t rbp;
+    uint64_t rflags;
+    uint64_t rip;
+    uint64_t rsp;
+};
+
+struct SwitchFrame {
+    uint64_t r15;
+    uint64_t r14;
+    uint64_t r13;
+    uint64_t r12;
+    uint64_t rbx;
+    uint64_t rbp;
+    uint64_t ret;
+};
+
+struct RealtimeState {
+    uint64_t period = 0;
+    uint64_t budget = 0;
+    uint64_t deadline = 0;
+    uint64_t abs_deadline = 0;
+    uint64_t remaining = 0;
+    uint64_t utilization = 0;
+    uint64_t deadline_misses = 0;
+    uint64_t throttles = 0;
+};
+
 class Process {
 public:
     Process();
     ~Process();
 
+    void reset();
+    void release_image();
+    void scrub_stack();
+
     void map_kernel_memory();
     uint64_t get_cr3() const;
 
-    void switch_to();
-    static void switch_to(Process& from, Process& to);
+    uint64_t kernel_stack_top() const;
+    SyscallFrame* syscall_frame() const;
+    void set_user_entry(uint64_t rip, uint64_t rsp);
+    void set_user_stack(uint64_t rsp);
 
     uint64_t brk(uint64_t addr);
     uint64_t sbrk(int64_t increment);
@@ -39,11 +100,25 @@ public:
 
     bool write_at(uint64_t vaddr, const void* data, size_t len);
 
-    cpu_context_t context;
+    uint64_t setup_ring();
+    void release_ring();
+
+    static constexpr uint64_t KERNEL_STACK_SIZE = 16384;
+
+    uint8_t* kernel_stack;
+    uint64_t kernel_rsp;
+    uint8_t* fpu_block;
+    uint8_t* fpu_area;
+    uint32_t fpu_cpu;
+    uint8_t* ring_block;
+    Ring* ring;
     ProcessState state;
-    Process* wait_queue_next;
-    Process* exit_wait_head;
-    Process* exit_wait_next;
+    Process* run_next;
+    Process* run_prev;
+    RunQueue* run_queue;
+    WaitQueue exit_queue;
+    KTimer sleep_timer;
+    KTimer rt_timer;
     uint64_t* pml4;
     uint64_t mapped_pages;
     uint64_t heap_start;
@@ -51,8 +126,17 @@ public:
     uint64_t stack_top;
     uint64_t stack_size;
     uint64_t pid;
+    size_t table_index;
+    uint32_t cpu;
+    uint64_t time_slice;
+    uint8_t priority;
+    ProcessStats stats;
+    RealtimeState rt;
     MemoryMapping memory_mapping;
 
 private:
+    void init_context();
+    void release_stack();
+
     static uint64_t next_pid;
 };
@@ -0,0 +1,39 @@
+#include "process_pool.h"
+#include "process.h"
+#include "fpu.h"
+
+ProcessPool process_pool;
+
+Process* ProcessPool::acquire() {
+    if (pooled_count == 0)
+        return new Process();
+    Process* proc = pooled[--pooled_count];
+    pooled[pooled_count] = nullptr;
+    if (scrubbed_count > pooled_count)
+        scrubbed_count = pooled_count;
+    proc->reset();
+    return proc;
+}
+
+void ProcessPool::release(Process* proc) {
+    if (!proc)
+        return;
+    Fpu::forget(*proc);
+    if (!proc->pml4 || !proc->kernel_stack || proc->stack_size == 0 || pooled_count >= MAX_POOLED) {
+        delete proc;
+        return;
+    }
+    proc->release_image();
+    pooled[pooled_count++] = proc;
+}
+
+bool ProcessPool::scrub_one() {
+    if (scrubbed_count >= pooled_count)
+        return false;
+    pooled[scrubbed_count++]->scrub_stack();
+    return true;
+}
+
+size_t ProcessPool::size() const {
+    return pooled_count;
+}
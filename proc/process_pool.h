@@ -0,0 +1,21 @@
+#pragma once
+#include "types/types.h"
+
+class Process;
+
+class ProcessPool {
+public:
+    static constexpr size_t MAX_POOLED = 8;
+
+    Process* acquire();
+    void release(Process* proc);
+    bool scrub_one();
+    size_t size() const;
+
+private:
+    Process* pooled[MAX_POOLED];
+    size_t pooled_count = 0;
+    size_t scrubbed_count = 0;
+};
+
+extern ProcessPool process_pool;
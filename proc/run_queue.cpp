@@ -0,0 +1,98 @@
+#include "run_queue.h"
+#include "process.h"
+
+void RunQueue::push_back(Process& proc) {
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    proc.run_next = nullptr;
+    proc.run_prev = tail;
+    if (tail)
+        tail->run_next = &proc;
+    else
+        head = &proc;
+    tail = &proc;
+    proc.run_queue = this;
+    ++count;
+}
+
+void RunQueue::push_front(Process& proc) {
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    proc.run_prev = nullptr;
+    proc.run_next = head;
+    if (head)
+        head->run_prev = &proc;
+    else
+        tail = &proc;
+    head = &proc;
+    proc.run_queue = this;
+    ++count;
+}
+
+void RunQueue::insert_by_deadline(Process& proc) {
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    Process* next = head;
+    while (next && next->rt.abs_deadline <= proc.rt.abs_deadline)
+        next = next->run_next;
+    if (!next) {
+        push_back(proc);
+        return;
+    }
+    proc.run_next = next;
+    proc.run_prev = next->run_prev;
+    if (next->run_prev)
+        next->run_prev->run_next = &proc;
+    else
+        head = &proc;
+    next->run_prev = &proc;
+    proc.run_queue = this;
+    ++count;
+}
+
+void RunQueue::remove(Process& proc) {
+    if (proc.run_queue != this)
+        return;
+    if (proc.run_prev)
+        proc.run_prev->run_next = proc.run_next;
+    else
+        head = proc.run_next;
+    if (proc.run_next)
+        proc.run_next->run_prev = proc.run_prev;
+    else
+        tail = proc.run_prev;
+    proc.run_next = nullptr;
+    proc.run_prev = nullptr;
+    proc.run_queue = nullptr;
+    --count;
+}
+
+Process* RunQueue::pop_front() {
+    Process* proc = head;
+    if (proc)
+        remove(*proc);
+    return proc;
+}
+
+Process* RunQueue::pop_back() {
+    Process* proc = tail;
+    if (proc)
+        remove(*proc);
+    return proc;
+}
+
+Process* RunQueue::front() const {
+    return head;
+}
+
+bool RunQueue::contains(const Process& proc) const {
+    return proc.run_queue == this;
+}
+
+bool RunQueue::empty() const {
+    return head == nullptr;
+}
+
+size_t RunQueue::size() const {
+    return count;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "types/types.h"
+
+class Process;
+
+class RunQueue {
+public:
+    void push_back(Process& proc);
+    void push_front(Process& proc);
+    void insert_by_deadline(Process& proc);
+    void remove(Process& proc);
+    Process* pop_front();
+    Process* pop_back();
+    Process* front() const;
+    bool contains(const Process& proc) const;
+    bool empty() const;
+    size_t size() const;
+
+private:
+    Process* head = nullptr;
+    Process* tail = nullptr;
+    size_t count = 0;
+};
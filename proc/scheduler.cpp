@@ -1,92 +1,514 @@
 #include "scheduler.h"
 #include "process.h"
+#include "process_pool.h"
+#include "idle.h"
+#include "fpu.h"
 #include "syscall_handler.h"
+#include "heap.h"
+#include "kmem.h"
+#include "timer.h"
+#include "timer_queue.h"
+#include "smp.h"
+#include "spinlock.h"
+#include "drivers/lapic.h"
+#include "types/cpu.h"
+
+extern "C" void context_switch(uint64_t* save_rsp, uint64_t next_rsp, uint64_t next_cr3);
 
 Scheduler scheduler;
 
-void Scheduler::init() {
+extern "C" void schedule_tail() {
+    scheduler.finish_switch();
+    kernel_lock.unlock();
+}
+
+void Scheduler::init(uint64_t default_slice) {
+    processes = nullptr;
     process_count = 0;
-    current_index = 0;
-    quantum = DEFAULT_QUANTUM;
+    process_capacity = 0;
+    default_quantum = default_slice ? default_slice : DEFAULT_QUANTUM;
+    this_cpu().quantum = default_quantum;
     tick_count = 0;
-    for (size_t i = 0; i < MAX_PROCESSES; ++i)
-        processes[i] = nullptr;
+    tick_handler_calls = 0;
+    tick_handler_cycles = 0;
+    tick_handler_max_cycles = 0;
+    migrations = 0;
+    rt_utilization = 0;
+    policy = SchedPolicy::RoundRobin;
+    last_boost_tick = 0;
 }
 
-void Scheduler::add_process(Process& proc) {
-    if (process_count >= MAX_PROCESSES)
+void Scheduler::set_policy(SchedPolicy new_policy) {
+    policy = new_policy;
+    boost_all();
+}
+
+void Scheduler::enqueue(Process& proc, bool at_front) {
+    if (is_realtime(proc)) {
+        if (proc.rt.remaining > 0)
+            rt_ready.insert_by_deadline(proc);
         return;
-    processes[process_count++] = &proc;
-    if (process_count == 1)
-        current_process = &proc;
+    }
+    size_t level = policy == SchedPolicy::Mlfq ? proc.priority : 0;
+    RunQueue& queue = cpus[proc.cpu].ready[level];
+    if (at_front)
+        queue.push_front(proc);
+    else
+        queue.push_back(proc);
 }
 
-void Scheduler::remove_process(Process& proc) {
-    for (size_t i = 0; i < process_count; ++i) {
-        if (processes[i] == &proc) {
-            for (size_t j = i; j + 1 < process_count; ++j)
-                processes[j] = processes[j + 1];
-            processes[--process_count] = nullptr;
-            if (current_process == &proc)
-                current_process = process_count > 0 ? processes[0] : nullptr;
-            if (current_index == i)
-                current_index = 0;
-            else if (current_index > i)
-                --current_index;
-            if (current_index >= process_count)
-                current_index = 0;
+Process* Scheduler::pop_highest() {
+    PerCpu& cpu = this_cpu();
+    if (Process* proc = rt_ready.pop_front()) {
+        if (proc->cpu != cpu.index) {
+            proc->cpu = cpu.index;
+            ++migrations;
+        }
+        return proc;
+    }
+    for (size_t level = 0; level < MLFQ_LEVELS; ++level) {
+        Process* proc = cpu.ready[level].pop_front();
+        if (proc)
+            return proc;
+    }
+    return steal();
+}
+
+Process* Scheduler::steal() {
+    PerCpu& self = this_cpu();
+    PerCpu* victim = nullptr;
+    size_t victim_load = 0;
+    for (size_t i = 0; i < MAX_CPUS; ++i) {
+        PerCpu& cpu = cpus[i];
+        if (&cpu == &self || !cpu.online)
+            continue;
+        size_t load = 0;
+        for (size_t level = 0; level < MLFQ_LEVELS; ++level)
+            load += cpu.ready[level].size();
+        if (load > victim_load) {
+            victim = &cpu;
+            victim_load = load;
+        }
+    }
+    if (!victim)
+        return nullptr;
+    for (size_t level = 0; level < MLFQ_LEVELS; ++level) {
+        Process* proc = victim->ready[level].pop_back();
+        if (proc) {
+            proc->cpu = self.index;
+            ++migrations;
+            return proc;
+        }
+    }
+    return nullptr;
+}
+
+size_t Scheduler::highest_ready_level() const {
+    PerCpu& cpu = this_cpu();
+    for (size_t level = 0; level < MLFQ_LEVELS; ++level) {
+        if (!cpu.ready[level].empty())
+            return level;
+    }
+    return MLFQ_LEVELS;
+}
+
+void Scheduler::boost_all() {
+    for (size_t i = 0; i < process_count; ++i)
+        processes[i]->priority = 0;
+    for (size_t i = 0; i < MAX_CPUS; ++i) {
+        for (size_t level = 1; level < MLFQ_LEVELS; ++level) {
+            while (Process* proc = cpus[i].ready[level].pop_front())
+                cpus[i].ready[0].push_back(*proc);
+        }
+    }
+    last_boost_tick = tick_count;
+}
+
+void Scheduler::kick(PerCpu& cpu) {
+    if (&cpu == &this_cpu())
+        return;
+    if (cpu.online && cpu.idle) {
+        Lapic::send_ipi(cpu.apic_id, Lapic::RESCHEDULE_VECTOR);
+        return;
+    }
+    for (size_t i = 0; i < MAX_CPUS; ++i) {
+        if (&cpus[i] != &this_cpu() && cpus[i].online && cpus[i].idle) {
+            Lapic::send_ipi(cpus[i].apic_id, Lapic::RESCHEDULE_VECTOR);
             return;
         }
     }
 }
 
-int Scheduler::find_next_runnable_index() {
-    if (process_count == 0) return -1;
-    for (size_t i = 0; i < process_count; ++i) {
-        size_t idx = (current_index + 1 + i) % process_count;
-        if (processes[idx]->state == ProcessState::Runnable)
-            return static_cast<int>(idx);
+bool Scheduler::grow_table() {
+    size_t new_capacity = process_capacity ? process_capacity * 2 : INITIAL_CAPACITY;
+    Process** table = static_cast<Process**>(kmalloc(new_capacity * sizeof(Process*)));
+    if (!table)
+        return false;
+    if (process_count > 0)
+        kmemcpy(table, processes, process_count * sizeof(Process*));
+    kfree(processes);
+    processes = table;
+    process_capacity = new_capacity;
+    return true;
+}
+
+bool Scheduler::add_process(Process& proc) {
+    if (process_count >= process_capacity && !grow_table())
+        return false;
+    if (!pid_map.insert(proc.pid, &proc))
+        return false;
+    PerCpu& cpu = this_cpu();
+    proc.cpu = cpu.index;
+    proc.table_index = process_count;
+    processes[process_count++] = &proc;
+    if (process_count == 1) {
+        cpu.current = &proc;
+        cpu.quantum = slice_for(proc);
+        start_running(proc);
+    } else if (proc.state == ProcessState::Runnable) {
+        enqueue(proc, false);
+        kick(cpus[proc.cpu]);
+    }
+    return true;
+}
+
+void Scheduler::remove_process(Process& proc) {
+    size_t i = proc.table_index;
+    if (i >= process_count || processes[i] != &proc)
+        return;
+    clear_realtime(proc);
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    pid_map.erase(proc.pid);
+    size_t last = --process_count;
+    processes[i] = processes[last];
+    processes[i]->table_index = i;
+    processes[last] = nullptr;
+    for (size_t c = 0; c < MAX_CPUS; ++c) {
+        if (cpus[c].current == &proc)
+            cpus[c].current = nullptr;
     }
-    return -1;
 }
 
-Process* Scheduler::tick() {
+void Scheduler::block(Process& proc) {
+    if (&proc == this_cpu().current)
+        stop_running(proc, true);
+    proc.state = ProcessState::Blocked;
+    proc.stats.blocked_since = tick_count;
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    if (policy == SchedPolicy::Mlfq)
+        proc.priority = 0;
+}
+
+void Scheduler::wake(Process& proc) {
+    if (proc.state != ProcessState::Blocked)
+        return;
+    proc.state = ProcessState::Runnable;
+    proc.stats.blocked_ticks += tick_count - proc.stats.blocked_since;
+    proc.stats.wake_tsc = rdtsc();
+    enqueue(proc, false);
+    kick(cpus[proc.cpu]);
+}
+
+bool Scheduler::set_realtime(Process& proc, uint64_t period, uint64_t budget, uint64_t deadline) {
+    if (period == 0) {
+        clear_realtime(proc);
+        return true;
+    }
+    if (deadline == 0)
+        deadline = period;
+    if (budget == 0 || budget > deadline || deadline > period)
+        return false;
+    uint64_t density = (budget * RT_UTILIZATION_SCALE + deadline - 1) / deadline;
+    uint64_t others = rt_utilization - proc.rt.utilization;
+    if (others + density > RT_UTILIZATION_LIMIT)
+        return false;
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    rt_utilization = others + density;
+    proc.rt.period = period;
+    proc.rt.budget = budget;
+    proc.rt.deadline = deadline;
+    proc.rt.utilization = density;
+    proc.rt_timer.callback = replenish;
+    proc.rt_timer.context = &proc;
+    release_job(proc);
+    if (proc.state == ProcessState::Runnable && cpus[proc.cpu].current != &proc) {
+        enqueue(proc, false);
+        kick(cpus[proc.cpu]);
+    }
+    return true;
+}
+
+void Scheduler::clear_realtime(Process& proc) {
+    if (!is_realtime(proc))
+        return;
+    timer_queue.cancel(proc.rt_timer);
+    rt_utilization -= proc.rt.utilization;
+    if (proc.run_queue)
+        proc.run_queue->remove(proc);
+    uint64_t misses = proc.rt.deadline_misses;
+    uint64_t throttles = proc.rt.throttles;
+    proc.rt = {};
+    proc.rt.deadline_misses = misses;
+    proc.rt.throttles = throttles;
+    if (proc.state == ProcessState::Runnable && cpus[proc.cpu].current != &proc)
+        enqueue(proc, false);
+}
+
+void Scheduler::release_job(Process& proc) {
+    if (proc.rt.remaining > 0 && proc.state == ProcessState::Runnable
+        && tick_count >= proc.rt.abs_deadline)
+        ++proc.rt.deadline_misses;
+    proc.rt.abs_deadline = tick_count + proc.rt.deadline;
+    proc.rt.remaining = proc.rt.budget;
+    timer_queue.arm(proc.rt_timer, tick_count + proc.rt.period);
+}
+
+void Scheduler::replenish(KTimer* timer) {
+    Process& proc = *static_cast<Process*>(timer->context);
+    scheduler.release_job(proc);
+    if (proc.state != ProcessState::Runnable || cpus[proc.cpu].current == &proc)
+        return;
+    scheduler.enqueue(proc, false);
+    scheduler.kick(cpus[proc.cpu]);
+}
+
+bool Scheduler::rt_preempts(const Process& current) const {
+    Process* head = rt_ready.front();
+    if (!head)
+        return false;
+    if (!is_realtime(current))
+        return true;
+    return head->rt.abs_deadline < current.rt.abs_deadline;
+}
+
+bool Scheduler::is_realtime(const Process& proc) {
+    return proc.rt.period != 0;
+}
+
+void Scheduler::account_tick() {
     ++tick_count;
-    if (quantum > 0)
-        --quantum;
+    timer_publish_ticks(tick_count);
+    if (policy == SchedPolicy::Mlfq && tick_count - last_boost_tick >= MLFQ_BOOST_INTERVAL)
+        boost_all();
+}
 
-    if (quantum > 0 || process_count == 0)
-        return current_process;
+void Scheduler::account_cpu_tick() {
+    PerCpu& cpu = this_cpu();
+    if (cpu.current) {
+        ++cpu.current->stats.run_ticks;
+        if (cpu.current->rt.remaining > 0)
+            --cpu.current->rt.remaining;
+    }
+    if (cpu.quantum > 0)
+        --cpu.quantum;
+}
 
-    quantum = DEFAULT_QUANTUM;
+Process* Scheduler::tick() {
+    PerCpu& cpu = this_cpu();
+    Process* current = cpu.current;
+    if (process_count == 0 || !current)
+        return current;
+
+    bool expired;
+    if (is_realtime(*current)) {
+        expired = current->rt.remaining == 0;
+        if (expired)
+            ++current->rt.throttles;
+        else if (!rt_preempts(*current))
+            return current;
+    } else {
+        expired = cpu.quantum == 0;
+        if (!expired) {
+            if (!rt_preempts(*current)
+                && (policy != SchedPolicy::Mlfq || highest_ready_level() >= current->priority))
+                return current;
+        } else if (policy == SchedPolicy::Mlfq && static_cast<size_t>(current->priority) + 1 < MLFQ_LEVELS) {
+            ++current->priority;
+        }
+    }
 
-    int next_idx = find_next_runnable_index();
-    if (next_idx < 0)
+    if (current->state == ProcessState::Runnable)
+        enqueue(*current, !expired);
+    Process* next = pop_highest();
+    if (next != current) {
+        stop_running(*current, false);
+        if (next)
+            start_running(*next);
+    }
+    cpu.current = next;
+    if (next)
+        cpu.quantum = slice_for(*next);
+    return next;
+}
+
+Process* Scheduler::yield() {
+    PerCpu& cpu = this_cpu();
+    Process* current = cpu.current;
+    if (!current)
+        return nullptr;
+    Process* next = pop_highest();
+    if (!next)
+        return current;
+    enqueue(*current, false);
+    stop_running(*current, true);
+    start_running(*next);
+    cpu.current = next;
+    cpu.quantum = slice_for(*next);
+    return next;
+}
+
+Process* Scheduler::yield_to(Process& target) {
+    PerCpu& cpu = this_cpu();
+    Process* current = cpu.current;
+    if (!current || &target == current)
+        return nullptr;
+    if (target.state != ProcessState::Runnable || !target.run_queue)
         return nullptr;
+    target.run_queue->remove(target);
+    if (target.cpu != cpu.index) {
+        target.cpu = cpu.index;
+        ++migrations;
+    }
+    enqueue(*current, false);
+    stop_running(*current, true);
+    start_running(target);
+    cpu.current = &target;
+    if (cpu.quantum == 0)
+        cpu.quantum = 1;
+    return &target;
+}
+
+void Scheduler::record_tick_cost(uint64_t cycles) {
+    ++tick_handler_calls;
+    tick_handler_cycles += cycles;
+    if (cycles > tick_handler_max_cycles)
+        tick_handler_max_cycles = cycles;
+}
+
+void Scheduler::start_running(Process& proc) {
+    uint64_t now = rdtsc();
+    proc.stats.run_start_tsc = now;
+    if (proc.stats.wake_tsc == 0)
+        return;
+    uint64_t latency = now - proc.stats.wake_tsc;
+    proc.stats.wake_tsc = 0;
+    ++proc.stats.wakeups;
+    proc.stats.wake_latency_cycles += latency;
+    if (latency > proc.stats.max_wake_latency_cycles)
+        proc.stats.max_wake_latency_cycles = latency;
+}
+
+void Scheduler::stop_running(Process& proc, bool voluntary) {
+    proc.stats.run_cycles += rdtsc() - proc.stats.run_start_tsc;
+    if (voluntary)
+        ++proc.stats.voluntary_switches;
+    else
+        ++proc.stats.involuntary_switches;
+}
 
-    current_index = static_cast<size_t>(next_idx);
-    current_process = processes[current_index];
-    return current_process;
+uint64_t Scheduler::slice_for(const Process& proc) const {
+    if (is_realtime(proc))
+        return proc.rt.remaining ? proc.rt.remaining : 1;
+    uint64_t base = proc.time_slice ? proc.time_slice : default_quantum;
+    if (policy == SchedPolicy::Mlfq)
+        return base << proc.priority;
+    return base;
 }
 
 Process* Scheduler::pick_next_runnable() {
-    int next_idx = find_next_runnable_index();
-    if (next_idx < 0)
-        return nullptr;
-    current_index = static_cast<size_t>(next_idx);
-    return processes[current_index];
+    Process* next = pop_highest();
+    if (next) {
+        this_cpu().quantum = slice_for(*next);
+        start_running(*next);
+    }
+    return next;
+}
+
+void Scheduler::switch_to(Process* prev, Process* next) {
+    if (prev == next)
+        return;
+    PerCpu& cpu = this_cpu();
+    bool in_syscall = cpu.in_syscall;
+    uint64_t* save_rsp = prev ? &prev->kernel_rsp : &cpu.idle_rsp;
+    uint64_t next_rsp = cpu.idle_rsp;
+    uint64_t next_cr3 = idle_cr3();
+    if (next) {
+        next_rsp = next->kernel_rsp;
+        next_cr3 = next->get_cr3();
+        cpu.kernel_stack = next->kernel_stack_top();
+        cpu.tss.rsp0 = cpu.kernel_stack;
+    }
+    Fpu::switch_to(cpu, prev, next);
+    cpu.current = next;
+    cpu.in_syscall = false;
+    context_switch(save_rsp, next_rsp, next_cr3);
+    this_cpu().in_syscall = in_syscall;
+    finish_switch();
+}
+
+void Scheduler::sleep(Process& proc) {
+    block(proc);
+    switch_to(&proc, pick_next_runnable());
+}
+
+void Scheduler::finish_switch() {
+    PerCpu& cpu = this_cpu();
+    Process* dead = cpu.dead;
+    if (!dead)
+        return;
+    cpu.dead = nullptr;
+    process_pool.release(dead);
+}
+
+bool Scheduler::has_runnable() const {
+    if (!rt_ready.empty())
+        return true;
+    for (size_t i = 0; i < MAX_CPUS; ++i) {
+        if (!cpus[i].online)
+            continue;
+        for (size_t level = 0; level < MLFQ_LEVELS; ++level) {
+            if (!cpus[i].ready[level].empty())
+                return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::idle_halt() {
+    bool tickless = this_cpu().index == 0 && smp_others_idle();
+    if (tickless) {
+        uint64_t wait_ticks = 0;
+        if (!timer_queue.empty()) {
+            uint64_t deadline = timer_queue.next_deadline();
+            wait_ticks = deadline > tick_count ? deadline - tick_count : 1;
+        }
+        timer_idle_enter(wait_ticks);
+    }
+    kernel_lock.unlock();
+    enable_interrupts_and_halt();
+    disable_interrupts();
+    kernel_lock.lock();
+    idle_catch_up();
+}
+
+void Scheduler::idle_catch_up() {
+    uint64_t skipped = timer_idle_exit();
+    if (skipped == 0)
+        return;
+    tick_count += skipped;
+    timer_publish_ticks(tick_count);
+    timer_queue.expire(tick_count);
 }
 
 Process* Scheduler::get_current() {
-    return current_process;
+    return this_cpu().current;
 }
 
 Process* Scheduler::find_process_by_pid(uint64_t pid) {
-    for (size_t i = 0; i < process_count; ++i) {
-        if (processes[i] && processes[i]->pid == pid)
-            return processes[i];
-    }
-    return nullptr;
+    return pid_map.find(pid);
 }
 
 uint64_t Scheduler::get_ticks() const {
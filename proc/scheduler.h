@@ -1,30 +1,80 @@
 #pragma once
 #include "types/types.h"
+#include "pid_map.h"
+#include "run_queue.h"
+#include "percpu.h"
+#include "timer_queue.h"
 
 class Process;
 
+enum class SchedPolicy : uint32_t { RoundRobin = 0, Mlfq = 1 };
+
 class Scheduler {
 public:
-    static constexpr size_t MAX_PROCESSES = 64;
-    static constexpr uint64_t DEFAULT_QUANTUM = 1;
+    static constexpr uint64_t DEFAULT_QUANTUM = 10;
+    static constexpr size_t MLFQ_LEVELS = SCHED_LEVELS;
+    static constexpr uint64_t MLFQ_BOOST_INTERVAL = 100;
+    static constexpr uint64_t RT_UTILIZATION_SCALE = 1000;
+    static constexpr uint64_t RT_UTILIZATION_LIMIT = 900;
 
-    void init();
-    void add_process(Process& proc);
+    void init(uint64_t default_slice);
+    void set_policy(SchedPolicy new_policy);
+    bool add_process(Process& proc);
     void remove_process(Process& proc);
+    void block(Process& proc);
+    void wake(Process& proc);
+    bool set_realtime(Process& proc, uint64_t period, uint64_t budget, uint64_t deadline);
+    void clear_realtime(Process& proc);
+    void account_tick();
+    void account_cpu_tick();
     Process* tick();
+    Process* yield();
+    Process* yield_to(Process& target);
+    void record_tick_cost(uint64_t cycles);
+    void start_running(Process& proc);
+    void stop_running(Process& proc, bool voluntary);
+    uint64_t slice_for(const Process& proc) const;
     Process* pick_next_runnable();
+    void switch_to(Process* prev, Process* next);
+    void sleep(Process& proc);
+    void finish_switch();
+    bool has_runnable() const;
+    void idle_halt();
+    void idle_catch_up();
     Process* get_current();
     Process* find_process_by_pid(uint64_t pid);
     uint64_t get_ticks() const;
 
-    Process* processes[MAX_PROCESSES];
+    Process** processes;
     size_t process_count;
-    size_t current_index;
-    uint64_t quantum;
+    size_t process_capacity;
+    uint64_t default_quantum;
     uint64_t tick_count;
+    uint64_t tick_handler_calls;
+    uint64_t tick_handler_cycles;
+    uint64_t tick_handler_max_cycles;
+    uint64_t migrations;
+    uint64_t rt_utilization;
+    SchedPolicy policy;
 
 private:
-    int find_next_runnable_index();
+    static constexpr size_t INITIAL_CAPACITY = 16;
+
+    bool grow_table();
+    void enqueue(Process& proc, bool at_front);
+    Process* pop_highest();
+    Process* steal();
+    size_t highest_ready_level() const;
+    void boost_all();
+    void kick(PerCpu& cpu);
+    void release_job(Process& proc);
+    bool rt_preempts(const Process& current) const;
+    static bool is_realtime(const Process& proc);
+    static void replenish(KTimer* timer);
+
+    uint64_t last_boost_tick;
+    RunQueue rt_ready;
+    PidMap pid_map;
 };
 
 extern Scheduler scheduler;
@@ -0,0 +1,125 @@
+#include "smp.h"
+#include "percpu.h"
+#include "spinlock.h"
+#include "idle.h"
+#include "fpu.h"
+#include "kmem.h"
+#include "timer.h"
+#include "syscall_handler.h"
+#include "drivers/lapic.h"
+#include "types/cpu.h"
+#include "types/idt.h"
+
+extern "C" char ap_trampoline_start[];
+extern "C" char ap_trampoline_end[];
+
+extern "C" {
+SpinLock kernel_lock;
+}
+
+PerCpu cpus[MAX_CPUS];
+
+static_assert(__builtin_offsetof(PerCpu, kernel_stack) == PERCPU_KERNEL_STACK, "syscall.asm expects kernel_stack at this offset");
+static_assert(__builtin_offsetof(PerCpu, user_rsp) == PERCPU_USER_RSP, "syscall.asm expects user_rsp at this offset");
+static_assert(__builtin_offsetof(PerCpu, in_syscall) == PERCPU_IN_SYSCALL, "syscall.asm expects in_syscall at this offset");
+static_assert(sizeof(Tss) == 104, "64-bit TSS is 104 bytes");
+
+namespace {
+
+constexpr uint64_t TRAMPOLINE_BASE = 0x8000;
+constexpr uint32_t IA32_GS_BASE = 0xC0000101;
+constexpr uint64_t INIT_DELAY_US = 10000;
+constexpr uint64_t STARTUP_DELAY_US = 200;
+constexpr uint64_t ONLINE_POLL_US = 100;
+constexpr uint64_t ONLINE_TIMEOUT_US = 100000;
+
+constexpr uint64_t GDT_KERNEL_CODE = 0x00AF9A000000FFFFULL;
+constexpr uint64_t GDT_KERNEL_DATA = 0x000092000000FFFFULL;
+constexpr uint64_t TSS_AVAILABLE = 0x89;
+
+uint32_t cpu_limit = 1;
+uint32_t online_count = 1;
+
+struct GdtPointer {
+    uint16_t limit;
+    uint64_t base;
+} __attribute__((packed));
+
+void load_gdt_and_tss(PerCpu& cpu) {
+    cpu.tss = {};
+    cpu.tss.iomap_base = sizeof(Tss);
+    uint64_t base = reinterpret_cast<uint64_t>(&cpu.tss);
+    uint64_t limit = sizeof(Tss) - 1;
+    cpu.gdt[0] = 0;
+    cpu.gdt[1] = GDT_KERNEL_CODE;
+    cpu.gdt[2] = GDT_KERNEL_DATA;
+    cpu.gdt[3] = (limit & 0xFFFF) | ((base & 0xFFFFFF) << 16) | (TSS_AVAILABLE << 40)
+        | (((limit >> 16) & 0xF) << 48) | (((base >> 24) & 0xFF) << 56);
+    cpu.gdt[4] = base >> 32;
+    GdtPointer pointer = { static_cast<uint16_t>(sizeof(cpu.gdt) - 1), reinterpret_cast<uint64_t>(cpu.gdt) };
+    asm volatile("lgdt %0" : : "m"(pointer));
+    asm volatile("ltr %0" : : "r"(TSS_SELECTOR));
+}
+
+}
+
+void percpu_init(uint32_t index) {
+    PerCpu& cpu = cpus[index];
+    cpu.self = &cpu;
+    cpu.index = index;
+    cpu.apic_id = Lapic::available() ? Lapic::id() : 0;
+    cpu.online = true;
+    load_gdt_and_tss(cpu);
+    Fpu::init_cpu();
+    wrmsr(IA32_GS_BASE, reinterpret_cast<uint64_t>(&cpu));
+}
+
+void smp_init(uint32_t max_cpus) {
+    cpu_limit = max_cpus < MAX_CPUS ? max_cpus : MAX_CPUS;
+    if (cpu_limit <= 1 || !Lapic::available())
+        return;
+    if (!Lapic::calibrate_timer(timer_frequency()))
+        return;
+    kmemcpy(reinterpret_cast<void*>(TRAMPOLINE_BASE), ap_trampoline_start,
+        static_cast<size_t>(ap_trampoline_end - ap_trampoline_start));
+    Lapic::broadcast_init();
+    timer_delay_us(INIT_DELAY_US);
+    Lapic::broadcast_startup(static_cast<uint8_t>(TRAMPOLINE_BASE >> 12));
+    timer_delay_us(STARTUP_DELAY_US);
+    Lapic::broadcast_startup(static_cast<uint8_t>(TRAMPOLINE_BASE >> 12));
+    for (uint64_t waited = 0; waited < ONLINE_TIMEOUT_US; waited += ONLINE_POLL_US) {
+        if (__atomic_load_n(&online_count, __ATOMIC_ACQUIRE) >= cpu_limit)
+            break;
+        timer_delay_us(ONLINE_POLL_US);
+    }
+}
+
+uint32_t smp_cpu_count() {
+    return __atomic_load_n(&online_count, __ATOMIC_ACQUIRE);
+}
+
+bool smp_others_idle() {
+    PerCpu& self = this_cpu();
+    for (size_t i = 0; i < MAX_CPUS; ++i) {
+        if (&cpus[i] != &self && cpus[i].online && !cpus[i].idle)
+            return false;
+    }
+    return true;
+}
+
+extern "C" void ap_main(uint32_t index) {
+    if (index >= cpu_limit) {
+        for (;;) {
+            disable_interrupts();
+            halt();
+        }
+    }
+    IDT::load();
+    initialize_syscalls();
+    Lapic::init_ap();
+    __atomic_add_fetch(&online_count, 1, __ATOMIC_RELEASE);
+    kernel_lock.lock();
+    percpu_init(index);
+    Lapic::start_timer();
+    idle_main();
+}
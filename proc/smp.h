@@ -0,0 +1,8 @@
+#pragma once
+#include "types/types.h"
+
+void smp_init(uint32_t max_cpus);
+uint32_t smp_cpu_count();
+bool smp_others_idle();
+
+extern "C" void ap_main(uint32_t index);
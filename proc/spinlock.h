@@ -0,0 +1,24 @@
+#pragma once
+#include "types/types.h"
+
+class SpinLock {
+public:
+    void lock() {
+        while (__atomic_exchange_n(&locked, 1u, __ATOMIC_ACQUIRE))
+            while (__atomic_load_n(&locked, __ATOMIC_RELAXED))
+                asm volatile("pause");
+    }
+
+    void unlock() {
+        __atomic_store_n(&locked, 0u, __ATOMIC_RELEASE);
+    }
+
+    bool is_locked() const {
+        return __atomic_load_n(&locked, __ATOMIC_RELAXED) != 0;
+    }
+
+private:
+    uint32_t locked = 0;
+};
+
+extern "C" SpinLock kernel_lock;
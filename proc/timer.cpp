@@ -1,17 +1,166 @@
 #include "timer.h"
 #include "types/cpu.h"
+#include "syscall/syscall.h"
 
 namespace {
 
 constexpr uint16_t PIT_COMMAND = 0x43;
 constexpr uint16_t PIT_CHANNEL0 = 0x40;
+constexpr uint16_t PIT_CHANNEL2 = 0x42;
+constexpr uint16_t PIT_GATE_PORT = 0x61;
+constexpr uint16_t PIC1_DATA = 0x21;
 constexpr uint32_t PIT_BASE_FREQ = 1193182;
+constexpr uint32_t PIT_MAX_DIVISOR = 0xFFFF;
+
+constexpr uint8_t PIT_CH0_PERIODIC = 0x36;
+constexpr uint8_t PIT_CH0_ONESHOT = 0x30;
+constexpr uint8_t PIT_CH2_ONESHOT = 0xB0;
+constexpr uint8_t PIT_GATE_ENABLE = 0x01;
+constexpr uint8_t PIT_SPEAKER_ENABLE = 0x02;
+constexpr uint8_t PIT_CH2_OUTPUT = 0x20;
+
+constexpr uint32_t CALIBRATE_HZ = 100;
+constexpr uint64_t CALIBRATE_SPIN_LIMIT = 10000000;
+
+uint32_t current_frequency = 0;
+uint32_t current_divisor = 0;
+uint64_t tsc_hz = 0;
+uint64_t tsc_per_tick = 0;
+
+alignas(4096) uint8_t time_page_block[4096];
+TimePage& time_page = *reinterpret_cast<TimePage*>(time_page_block);
+
+bool idle_active = false;
+bool idle_fired = false;
+uint64_t idle_programmed_ticks = 0;
+uint64_t idle_start_tsc = 0;
+uint64_t idle_tsc_carry = 0;
+
+void program_channel0(uint8_t mode, uint32_t count) {
+    outb(PIT_COMMAND, mode);
+    outb(PIT_CHANNEL0, count & 0xFF);
+    outb(PIT_CHANNEL0, (count >> 8) & 0xFF);
+}
+
+void mask_timer_irq(bool masked) {
+    uint8_t mask = inb(PIC1_DATA);
+    outb(PIC1_DATA, masked ? (mask | 0x01) : (mask & ~0x01));
+}
+
+uint64_t calibrate_tsc() {
+    uint8_t gate = inb(PIT_GATE_PORT);
+    outb(PIT_GATE_PORT, (gate & ~PIT_SPEAKER_ENABLE) | PIT_GATE_ENABLE);
+    uint32_t count = PIT_BASE_FREQ / CALIBRATE_HZ;
+    outb(PIT_COMMAND, PIT_CH2_ONESHOT);
+    outb(PIT_CHANNEL2, count & 0xFF);
+    outb(PIT_CHANNEL2, (count >> 8) & 0xFF);
+    uint64_t start = rdtsc();
+    uint64_t spins = 0;
+    while (!(inb(PIT_GATE_PORT) & PIT_CH2_OUTPUT)) {
+        if (++spins > CALIBRATE_SPIN_LIMIT) {
+            outb(PIT_GATE_PORT, gate);
+            return 0;
+        }
+    }
+    uint64_t end = rdtsc();
+    outb(PIT_GATE_PORT, gate);
+    return (end - start) * CALIBRATE_HZ;
+}
 
 }
 
 void timer_init(uint32_t frequency) {
+    if (frequency == 0)
+        frequency = DEFAULT_TIMER_HZ;
+    if (frequency > MAX_TIMER_HZ)
+        frequency = MAX_TIMER_HZ;
     uint32_t divisor = PIT_BASE_FREQ / frequency;
-    outb(PIT_COMMAND, 0x36);
-    outb(PIT_CHANNEL0, divisor & 0xFF);
-    outb(PIT_CHANNEL0, (divisor >> 8) & 0xFF);
+    if (divisor > PIT_MAX_DIVISOR)
+        divisor = PIT_MAX_DIVISOR;
+    current_divisor = divisor;
+    current_frequency = PIT_BASE_FREQ / divisor;
+    if (tsc_hz == 0)
+        tsc_hz = calibrate_tsc();
+    tsc_per_tick = tsc_hz / current_frequency;
+    time_page.hz = current_frequency;
+    time_page.tsc_hz = tsc_hz;
+    time_page.tsc_per_tick = tsc_per_tick;
+    if (time_page.boot_tsc == 0)
+        time_page.boot_tsc = rdtsc();
+    timer_publish_ticks(time_page.ticks);
+    program_channel0(PIT_CH0_PERIODIC, divisor);
+}
+
+void timer_publish_ticks(uint64_t ticks) {
+    uint32_t seq = time_page.seq;
+    __atomic_store_n(&time_page.seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    time_page.ticks = ticks;
+    time_page.tick_tsc = rdtsc();
+    __atomic_store_n(&time_page.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+uint64_t timer_page_phys() {
+    return reinterpret_cast<uint64_t>(time_page_block);
+}
+
+uint32_t timer_frequency() {
+    return current_frequency;
+}
+
+uint64_t timer_tsc_hz() {
+    return tsc_hz;
+}
+
+uint64_t timer_tsc_per_tick() {
+    return tsc_per_tick;
+}
+
+void timer_delay_us(uint64_t us) {
+    uint64_t cycles = tsc_hz / 1000000 * us;
+    uint64_t start = rdtsc();
+    while (rdtsc() - start < cycles)
+        asm volatile("pause");
+}
+
+void timer_idle_enter(uint64_t ticks_until_event) {
+    if (tsc_per_tick == 0)
+        return;
+    idle_active = true;
+    idle_fired = false;
+    idle_start_tsc = rdtsc();
+    if (ticks_until_event == 0) {
+        idle_programmed_ticks = 0;
+        mask_timer_irq(true);
+        return;
+    }
+    uint64_t count = ticks_until_event * current_divisor;
+    if (count > PIT_MAX_DIVISOR)
+        count = PIT_MAX_DIVISOR;
+    idle_programmed_ticks = count / current_divisor;
+    program_channel0(PIT_CH0_ONESHOT, static_cast<uint32_t>(count));
+}
+
+uint64_t timer_idle_exit() {
+    if (!idle_active)
+        return 0;
+    idle_active = false;
+    program_channel0(PIT_CH0_PERIODIC, current_divisor);
+    if (idle_programmed_ticks == 0)
+        mask_timer_irq(false);
+    uint64_t cycles = rdtsc() - idle_start_tsc + idle_tsc_carry;
+    uint64_t elapsed = cycles / tsc_per_tick;
+    idle_tsc_carry = cycles % tsc_per_tick;
+    if (idle_fired && elapsed < idle_programmed_ticks) {
+        elapsed = idle_programmed_ticks;
+        idle_tsc_carry = 0;
+    }
+    return elapsed;
+}
+
+bool timer_idle_interrupt() {
+    if (!idle_active)
+        return false;
+    idle_fired = true;
+    return true;
 }
@@ -1,4 +1,17 @@
 #pragma once
 #include "types/types.h"
 
+constexpr uint32_t DEFAULT_TIMER_HZ = 100;
+constexpr uint32_t MAX_TIMER_HZ = 10000;
+
 void timer_init(uint32_t frequency);
+uint32_t timer_frequency();
+uint64_t timer_tsc_hz();
+uint64_t timer_tsc_per_tick();
+void timer_publish_ticks(uint64_t ticks);
+uint64_t timer_page_phys();
+void timer_delay_us(uint64_t us);
+
+void timer_idle_enter(uint64_t ticks_until_event);
+uint64_t timer_idle_exit();
+bool timer_idle_interrupt();
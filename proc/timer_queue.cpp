@@ -0,0 +1,55 @@
+#include "timer_queue.h"
+
+TimerQueue timer_queue;
+
+void TimerQueue::arm(KTimer& timer, uint64_t deadline) {
+    if (timer.armed)
+        cancel(timer);
+    timer.deadline = deadline;
+    KTimer* prev = nullptr;
+    KTimer* cur = head;
+    while (cur && cur->deadline <= deadline) {
+        prev = cur;
+        cur = cur->next;
+    }
+    timer.prev = prev;
+    timer.next = cur;
+    if (prev)
+        prev->next = &timer;
+    else
+        head = &timer;
+    if (cur)
+        cur->prev = &timer;
+    timer.armed = true;
+}
+
+void TimerQueue::cancel(KTimer& timer) {
+    if (!timer.armed)
+        return;
+    if (timer.prev)
+        timer.prev->next = timer.next;
+    else
+        head = timer.next;
+    if (timer.next)
+        timer.next->prev = timer.prev;
+    timer.next = nullptr;
+    timer.prev = nullptr;
+    timer.armed = false;
+}
+
+void TimerQueue::expire(uint64_t now) {
+    while (head && head->deadline <= now) {
+        KTimer* timer = head;
+        cancel(*timer);
+        if (timer->callback)
+            timer->callback(timer);
+    }
+}
+
+bool TimerQueue::empty() const {
+    return head == nullptr;
+}
+
+uint64_t TimerQueue::next_deadline() const {
+    return head ? head->deadline : 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "types/types.h"
+
+struct KTimer {
+    uint64_t deadline = 0;
+    KTimer* next = nullptr;
+    KTimer* prev = nullptr;
+    void (*callback)(KTimer* timer) = nullptr;
+    void* context = nullptr;
+    bool armed = false;
+};
+
+class TimerQueue {
+public:
+    void arm(KTimer& timer, uint64_t deadline);
+    void cancel(KTimer& timer);
+    void expire(uint64_t now);
+    bool empty() const;
+    uint64_t next_deadline() const;
+
+private:
+    KTimer* head = nullptr;
+};
+
+extern TimerQueue timer_queue;
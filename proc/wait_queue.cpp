@@ -0,0 +1,75 @@
+#include "wait_queue.h"
+#include "process.h"
+#include "scheduler.h"
+#include "timer_queue.h"
+
+static void wait_timeout(KTimer* timer) {
+    scheduler.wake(*static_cast<Process*>(timer->context));
+}
+
+bool WaitQueue::wait(Process& proc, uint64_t timeout_ticks) {
+    WaitEntry entry;
+    entry.process = &proc;
+    add(entry);
+    if (timeout_ticks != NO_TIMEOUT) {
+        proc.sleep_timer.callback = wait_timeout;
+        proc.sleep_timer.context = &proc;
+        timer_queue.arm(proc.sleep_timer, scheduler.get_ticks() + timeout_ticks);
+    }
+    scheduler.sleep(proc);
+    if (timeout_ticks != NO_TIMEOUT)
+        timer_queue.cancel(proc.sleep_timer);
+    remove(entry);
+    return entry.woken;
+}
+
+void WaitQueue::add(WaitEntry& entry) {
+    if (entry.queue)
+        entry.queue->remove(entry);
+    entry.next = nullptr;
+    entry.prev = tail;
+    if (tail)
+        tail->next = &entry;
+    else
+        head = &entry;
+    tail = &entry;
+    entry.queue = this;
+    entry.woken = false;
+}
+
+void WaitQueue::remove(WaitEntry& entry) {
+    if (entry.queue != this)
+        return;
+    if (entry.prev)
+        entry.prev->next = entry.next;
+    else
+        head = entry.next;
+    if (entry.next)
+        entry.next->prev = entry.prev;
+    else
+        tail = entry.prev;
+    entry.next = nullptr;
+    entry.prev = nullptr;
+    entry.queue = nullptr;
+}
+
+Process* WaitQueue::wake_one() {
+    WaitEntry* entry = head;
+    if (!entry)
+        return nullptr;
+    remove(*entry);
+    entry->woken = true;
+    scheduler.wake(*entry->process);
+    return entry->process;
+}
+
+size_t WaitQueue::wake_all() {
+    size_t woken = 0;
+    while (wake_one())
+        ++woken;
+    return woken;
+}
+
+bool WaitQueue::empty() const {
+    return head == nullptr;
+}
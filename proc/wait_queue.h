@@ -0,0 +1,29 @@
+#pragma once
+#include "types/types.h"
+
+class Process;
+class WaitQueue;
+
+struct WaitEntry {
+    Process* process = nullptr;
+    WaitEntry* next = nullptr;
+    WaitEntry* prev = nullptr;
+    WaitQueue* queue = nullptr;
+    bool woken = false;
+};
+
+class WaitQueue {
+public:
+    static constexpr uint64_t NO_TIMEOUT = 0;
+
+    bool wait(Process& proc, uint64_t timeout_ticks = NO_TIMEOUT);
+    void add(WaitEntry& entry);
+    void remove(WaitEntry& entry);
+    Process* wake_one();
+    size_t wake_all();
+    bool empty() const;
+
+private:
+    WaitEntry* head = nullptr;
+    WaitEntry* tail = nullptr;
+};
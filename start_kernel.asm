@@ -22,6 +22,7 @@ tss: resb 108              ; 64-bit TSS (RSP0 at offset 4)
 
 ; Writable GDT copy so we can set TSS base without touching .rodata (multiboot header must stay early)
 gdt_copy:    resb 40       ; 5 descriptors
+global gdt_ptr_copy
 gdt_ptr_copy: resb 10      ; limit (2) + base (4) for lgdt; 64-bit lgdt uses 2+8 but we only need 4-byte base
 
 align 4096                 ; Page tables must be 4 KiB-aligned (bits 11:0 == 0)
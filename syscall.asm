@@ -1,38 +1,56 @@
 global syscall_entry
+global syscall_exit
+global process_first_entry
 extern syscall_handler
-extern in_syscall
+extern schedule_tail
+
+%define PERCPU_KERNEL_STACK 8
+%define PERCPU_USER_RSP 16
+%define PERCPU_IN_SYSCALL 24
 
 syscall_entry:
+    mov [gs:PERCPU_USER_RSP], rsp
+    mov rsp, [gs:PERCPU_KERNEL_STACK]
+    push qword [gs:PERCPU_USER_RSP]
+    push rcx
+    push r11
     push rbp
     push rbx
     push r12
     push r13
     push r14
     push r15
-    push rcx
-    push r11
+    sub rsp, 8
     mov r14, rax
     mov r15, r10
-    mov r9, r8         
-    mov r8, r15        
-    mov rcx, rdx       
-    mov rdx, rsi       
-    mov rsi, rdi       
+    mov r9, r8
+    mov r8, r15
+    mov rcx, rdx
+    mov rdx, rsi
+    mov rsi, rdi
     mov rdi, r14
 
-    mov byte [rel in_syscall], 1
+    mov byte [gs:PERCPU_IN_SYSCALL], 1
     call syscall_handler
-    mov byte [rel in_syscall], 0
-    pop r11
-    pop rcx
-
+syscall_exit:
+    mov byte [gs:PERCPU_IN_SYSCALL], 0
+    add rsp, 8
     pop r15
     pop r14
     pop r13
     pop r12
     pop rbx
     pop rbp
+    pop r11
+    pop rcx
+    pop rsp
 
     push r11
     popfq
-    jmp rcx
\ No newline at end of file
+    jmp rcx
+
+;  A new process is first switched to here; it leaves through the syscall return path
+process_first_entry:
+    call schedule_tail
+    xor eax, eax
+    jmp syscall_exit
@@ -0,0 +1,20 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "idle.h"
+
+uint64_t syscall_clock(uint64_t a0) {
+    ClockInfo* out = reinterpret_cast<ClockInfo*>(a0);
+    if (!out)
+        return static_cast<uint64_t>(-1);
+    out->hz = timer_frequency();
+    out->ticks = scheduler.get_ticks();
+    out->tick_handler_calls = scheduler.tick_handler_calls;
+    out->tick_handler_cycles = scheduler.tick_handler_cycles;
+    out->tick_handler_max_cycles = scheduler.tick_handler_max_cycles;
+    out->idle_entries = idle_stats.entries;
+    out->idle_cycles = idle_stats.cycles;
+    out->tsc_hz = timer_tsc_hz();
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+
+uint64_t syscall_deadline(uint64_t a0, uint64_t a1) {
+    const DeadlineParams* params = reinterpret_cast<const DeadlineParams*>(a1);
+    Process* target = a0 == 0 ? this_cpu().current : scheduler.find_process_by_pid(a0);
+    if (!target)
+        return static_cast<uint64_t>(-1);
+    if (!params) {
+        scheduler.clear_realtime(*target);
+        return 0;
+    }
+    if (!scheduler.set_realtime(*target, params->period, params->budget, params->deadline))
+        return static_cast<uint64_t>(-1);
+    return 0;
+}
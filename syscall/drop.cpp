@@ -1,33 +1,17 @@
 #include "syscall/impl.h"
 #include "syscall/syscall.h"
-#include "types/cpu.h"
 #include "process.h"
 #include "scheduler.h"
-
-extern "C" void process_restore_and_switch_to_ctx(cpu_context_t* to_ctx, uint64_t new_cr3);
+#include "percpu.h"
 
 uint64_t syscall_drop() {
-    if (!current_process)
+    PerCpu& cpu = this_cpu();
+    if (!cpu.current)
         return static_cast<uint64_t>(-1);
-    Process* exiting = current_process;
-    for (Process* w = exiting->exit_wait_head; w; w = w->exit_wait_next)
-        w->state = ProcessState::Runnable;
+    Process* exiting = cpu.current;
+    exiting->exit_queue.wake_all();
     scheduler.remove_process(*exiting);
-    delete exiting;
-    if (current_process != nullptr && current_process->state == ProcessState::Blocked) {
-        current_process = scheduler.pick_next_runnable();
-    }
-    if (current_process != nullptr) {
-        process_restore_and_switch_to_ctx(&current_process->context, current_process->get_cr3());
-    }
-    enable_interrupts();
-    for (;;) {
-        halt();
-        Process* woken = scheduler.pick_next_runnable();
-        if (woken) {
-            disable_interrupts();
-            current_process = woken;
-            process_restore_and_switch_to_ctx(&current_process->context, current_process->get_cr3());
-        }
-    }
+    cpu.dead = exiting;
+    scheduler.switch_to(exiting, scheduler.pick_next_runnable());
+    return 0;
 }
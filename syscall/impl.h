@@ -10,3 +10,18 @@ uint64_t syscall_meow(uint64_t a0, uint64_t a1, uint64_t a2);
 uint64_t syscall_drop();
 uint64_t syscall_list(uint64_t a0, uint64_t a1);
 uint64_t syscall_wait(uint64_t a0);
+uint64_t syscall_slice(uint64_t a0, uint64_t a1);
+uint64_t syscall_clock(uint64_t a0);
+uint64_t syscall_nap(uint64_t a0, uint64_t a1);
+uint64_t syscall_yield(uint64_t a0);
+uint64_t syscall_stats(uint64_t a0, uint64_t a1);
+uint64_t syscall_purr(uint64_t a0, uint64_t a1);
+uint64_t syscall_self();
+uint64_t syscall_deadline(uint64_t a0, uint64_t a1);
+uint64_t syscall_profile(uint64_t a0, uint64_t a1);
+uint64_t syscall_ring();
+uint64_t syscall_submit(uint64_t a0);
+uint64_t syscall_meowv(uint64_t a0, uint64_t a1, uint64_t a2);
+uint64_t syscall_petv(uint64_t a0, uint64_t a1, uint64_t a2);
+uint64_t syscall_tty(uint64_t a0);
+uint64_t syscall_poll(uint64_t a0, uint64_t a1, uint64_t a2);
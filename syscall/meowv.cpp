@@ -0,0 +1,45 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "drivers/framebuffer.h"
+#include "fs/filesystem.h"
+#include "fs/fs_error.h"
+#include "fs/fs_structs.h"
+
+extern fs::FileSystem* g_fs;
+
+uint64_t syscall_meowv(uint64_t a0, uint64_t a1, uint64_t a2) {
+    const char* filename_ptr = reinterpret_cast<const char*>(a0);
+    const IoVec* iov = reinterpret_cast<const IoVec*>(a1);
+    uint64_t count = a2;
+    if (count > MAX_IOV || (count > 0 && iov == nullptr))
+        return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::InvalidArg));
+    fs::IoSegment segs[MAX_IOV];
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (iov[i].len > 0xFFFFFFFFu || (iov[i].len > 0 && iov[i].base == 0))
+            return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::InvalidArg));
+        segs[i].base = reinterpret_cast<const void*>(iov[i].base);
+        segs[i].len = static_cast<uint32_t>(iov[i].len);
+        total += iov[i].len;
+    }
+    if (filename_ptr == nullptr) {
+        for (uint64_t i = 0; i < count; ++i)
+            g_framebuffer.write_raw(segs[i].base, segs[i].len);
+        g_framebuffer.sync_cursor();
+        return total;
+    }
+    if (!g_fs || !g_fs->is_mounted())
+        return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::NotMounted));
+    char name_buf[fs::MAX_NAME_LEN];
+    for (uint32_t i = 0; i < fs::MAX_NAME_LEN; ++i) {
+        name_buf[i] = filename_ptr[i];
+        if (filename_ptr[i] == '\0')
+            break;
+        if (i == fs::MAX_NAME_LEN - 1)
+            name_buf[i] = '\0';
+    }
+    fs::Error err = g_fs->write_file_vec(name_buf, segs, static_cast<uint32_t>(count));
+    if (err != fs::Error::Ok)
+        return static_cast<uint64_t>(static_cast<int64_t>(err));
+    return total;
+}
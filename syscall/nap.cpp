@@ -0,0 +1,26 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+#include "timer_queue.h"
+
+static void wake_sleeper(KTimer* timer) {
+    scheduler.wake(*static_cast<Process*>(timer->context));
+}
+
+uint64_t syscall_nap(uint64_t a0, uint64_t a1) {
+    Process* blocked = this_cpu().current;
+    if (!blocked)
+        return static_cast<uint64_t>(-1);
+    uint64_t now = scheduler.get_ticks();
+    uint64_t deadline = a1 ? a0 : now + a0;
+    if (deadline <= now)
+        return 0;
+
+    blocked->sleep_timer.callback = wake_sleeper;
+    blocked->sleep_timer.context = blocked;
+    timer_queue.arm(blocked->sleep_timer, deadline);
+    scheduler.sleep(*blocked);
+    return 0;
+}
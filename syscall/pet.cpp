@@ -1,17 +1,16 @@
 #include "syscall/impl.h"
 #include "syscall/syscall.h"
-#include "types/cpu.h"
 #include "process.h"
 #include "scheduler.h"
+#include "percpu.h"
 #include "drivers/keyboard.h"
+#include "drivers/tty.h"
+#include "wait_queue.h"
 #include "fs/filesystem.h"
 #include "fs/fs_error.h"
 #include "fs/fs_structs.h"
 
 extern fs::FileSystem* g_fs;
-extern "C" bool in_syscall;
-extern "C" void save_context_and_switch_to(cpu_context_t* save_ctx, void* resume_rip,
-                                           cpu_context_t* next_ctx, uint64_t next_cr3);
 
 uint64_t syscall_pet(uint64_t a0, uint64_t a1, uint64_t a2) {
     const char* filename_ptr = reinterpret_cast<const char*>(a0);
@@ -20,37 +19,13 @@ uint64_t syscall_pet(uint64_t a0, uint64_t a1, uint64_t a2) {
     if (buffer == nullptr || max_size == 0)
         return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::InvalidArg));
     if (filename_ptr == nullptr) {
-        if (!Keyboard::has_char()) {
-            Process* blocked = current_process;
-            keyboard_wait_add(blocked);
-            blocked->state = ProcessState::Blocked;
-            Process* next = scheduler.pick_next_runnable();
-            if (next == nullptr) {
-                enable_interrupts();
-                while (!Keyboard::has_char())
-                    halt();
-                disable_interrupts();
-                next = scheduler.pick_next_runnable();
-                if (next != nullptr) {
-                    current_process = next;
-                    in_syscall = false;
-                    save_context_and_switch_to(&blocked->context, &&pet_keyboard_resume,
-                        &next->context, next->get_cr3());
-                }
-            }
-            if (next != nullptr) {
-                current_process = next;
-                in_syscall = false;
-                save_context_and_switch_to(&blocked->context, &&pet_keyboard_resume,
-                    &next->context, next->get_cr3());
-            }
-        }
-    pet_keyboard_resume:
-        {
-            char* dst = reinterpret_cast<char*>(buffer);
-            char c = Keyboard::getchar();
-            dst[0] = c;
-            return 1;
+        char* dst = reinterpret_cast<char*>(buffer);
+        for (;;) {
+            uint32_t got = Tty::read(dst, max_size);
+            if (got > 0)
+                return got;
+            if (!Keyboard::has_char())
+                keyboard_queue.wait(*this_cpu().current);
         }
     }
     if (!g_fs || !g_fs->is_mounted())
@@ -0,0 +1,37 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "fs/filesystem.h"
+#include "fs/fs_error.h"
+#include "fs/fs_structs.h"
+
+extern fs::FileSystem* g_fs;
+
+uint64_t syscall_petv(uint64_t a0, uint64_t a1, uint64_t a2) {
+    const char* filename_ptr = reinterpret_cast<const char*>(a0);
+    const IoVec* iov = reinterpret_cast<const IoVec*>(a1);
+    uint64_t count = a2;
+    if (filename_ptr == nullptr || count > MAX_IOV || (count > 0 && iov == nullptr))
+        return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::InvalidArg));
+    fs::IoBuffer bufs[MAX_IOV];
+    for (uint64_t i = 0; i < count; ++i) {
+        if (iov[i].len > 0xFFFFFFFFu || (iov[i].len > 0 && iov[i].base == 0))
+            return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::InvalidArg));
+        bufs[i].base = reinterpret_cast<void*>(iov[i].base);
+        bufs[i].len = static_cast<uint32_t>(iov[i].len);
+    }
+    if (!g_fs || !g_fs->is_mounted())
+        return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::NotMounted));
+    char name_buf[fs::MAX_NAME_LEN];
+    for (uint32_t i = 0; i < fs::MAX_NAME_LEN; ++i) {
+        name_buf[i] = filename_ptr[i];
+        if (filename_ptr[i] == '\0')
+            break;
+        if (i == fs::MAX_NAME_LEN - 1)
+            name_buf[i] = '\0';
+    }
+    uint32_t bytes_read = 0;
+    fs::Error err = g_fs->read_file_vec(name_buf, bufs, static_cast<uint32_t>(count), &bytes_read);
+    if (err != fs::Error::Ok)
+        return static_cast<uint64_t>(static_cast<int64_t>(err));
+    return static_cast<uint64_t>(bytes_read);
+}
@@ -1,10 +1,14 @@
 #include "syscall/impl.h"
 #include "syscall/syscall.h"
 #include "process.h"
+#include "process_pool.h"
 #include "scheduler.h"
+#include "percpu.h"
+#include "fpu.h"
 #include "fs/filesystem.h"
 #include "fs/fs_error.h"
 #include "heap.h"
+#include "kmem.h"
 #include "fs/fs_structs.h"
 
 namespace {
@@ -16,7 +20,6 @@ constexpr uint32_t MAX_ARGC = 32;
 }
 
 extern fs::FileSystem* g_fs;
-extern "C" void process_restore_and_switch_to_ctx(cpu_context_t* to_ctx, uint64_t new_cr3);
 
 static uint32_t parse_cmdline(char* line_buf, uint32_t line_len, const char* argv_out[MAX_ARGC]) {
     uint32_t argc = 0;
@@ -74,13 +77,15 @@ static bool setup_argc_argv(Process* proc, uint64_t stack_top, uint32_t argc, co
     for (uint32_t i = 0; i < argc; ++i) {
         const char* s = argv[i];
         while (*s)
-            buf[off++] = *s++;
-        buf[off++] = '\0';
+            ++s;
+        size_t len = static_cast<size_t>(s - argv[i]) + 1;
+        kmemcpy(buf + off, argv[i], len);
+        off += len;
     }
     bool ok = proc->write_at(base, buf, total);
     kfree(buf);
     if (ok)
-        proc->context.rsp = base;
+        proc->set_user_stack(base);
     return ok;
 }
 
@@ -123,40 +128,40 @@ uint64_t syscall_play(uint64_t a0, uint64_t a1, uint64_t a2) {
         return static_cast<uint64_t>(static_cast<int64_t>(err));
     }
     if (spawn) {
-        if (scheduler.process_count >= Scheduler::MAX_PROCESSES) {
-            kfree(buffer);
-            return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::NoSpace));
-        }
-        Process* proc = new Process();
+        Process* proc = process_pool.acquire();
         if (!proc->pml4) {
             kfree(buffer);
-            delete proc;
+            process_pool.release(proc);
             return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::NoSpace));
         }
         if (!proc->load_binary(buffer, bytes_read, HEAP_START_VIRT)) {
             kfree(buffer);
-            delete proc;
+            process_pool.release(proc);
             return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::IOError));
         }
         if (!setup_argc_argv(proc, STACK_TOP_VIRT, argc, argv)) {
             kfree(buffer);
-            delete proc;
+            process_pool.release(proc);
             return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::NoSpace));
         }
         kfree(buffer);
-        scheduler.add_process(*proc);
+        if (!scheduler.add_process(*proc)) {
+            process_pool.release(proc);
+            return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::NoSpace));
+        }
         return static_cast<uint64_t>(proc->pid);
     }
-    if (!current_process) {
+    Process* current = this_cpu().current;
+    if (!current) {
         kfree(buffer);
         return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::InvalidArg));
     }
-    if (!current_process->load_binary(buffer, bytes_read, HEAP_START_VIRT)) {
+    current->release_image();
+    if (!current->load_binary(buffer, bytes_read, HEAP_START_VIRT)) {
         kfree(buffer);
-        return static_cast<uint64_t>(static_cast<int64_t>(fs::Error::IOError));
+        return syscall_drop();
     }
     kfree(buffer);
-    process_restore_and_switch_to_ctx(&current_process->context, current_process->get_cr3());
-    for (;;)
-        asm volatile("hlt");
+    Fpu::forget(*current);
+    return 0;
 }
@@ -0,0 +1,102 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+#include "timer_queue.h"
+#include "wait_queue.h"
+#include "drivers/tty.h"
+
+static constexpr uint64_t NO_DEADLINE = ~0ULL;
+
+static void wake_poller(KTimer* timer) {
+    scheduler.wake(*static_cast<Process*>(timer->context));
+}
+
+static bool poll_valid(const PollEvent& event, const Process& self) {
+    switch (static_cast<PollSource>(event.source)) {
+    case PollSource::Keyboard:
+    case PollSource::Timer:
+        return true;
+    case PollSource::Child:
+        return event.arg != self.pid;
+    }
+    return false;
+}
+
+static bool poll_ready(const PollEvent& event) {
+    switch (static_cast<PollSource>(event.source)) {
+    case PollSource::Keyboard:
+        return Tty::readable();
+    case PollSource::Child:
+        return scheduler.find_process_by_pid(event.arg) == nullptr;
+    case PollSource::Timer:
+        return scheduler.get_ticks() >= event.arg;
+    }
+    return false;
+}
+
+static WaitQueue* poll_queue(const PollEvent& event) {
+    switch (static_cast<PollSource>(event.source)) {
+    case PollSource::Keyboard:
+        return &keyboard_queue;
+    case PollSource::Child: {
+        Process* child = scheduler.find_process_by_pid(event.arg);
+        return child ? &child->exit_queue : nullptr;
+    }
+    case PollSource::Timer:
+        return nullptr;
+    }
+    return nullptr;
+}
+
+static uint64_t poll_scan(PollEvent* events, uint64_t count) {
+    uint64_t ready = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        events[i].ready = poll_ready(events[i]) ? 1 : 0;
+        ready += events[i].ready;
+    }
+    return ready;
+}
+
+uint64_t syscall_poll(uint64_t a0, uint64_t a1, uint64_t a2) {
+    Process* self = this_cpu().current;
+    PollEvent* events = reinterpret_cast<PollEvent*>(a0);
+    uint64_t count = a1;
+    if (!self || count == 0 || count > MAX_POLL || !events)
+        return static_cast<uint64_t>(-1);
+    uint64_t deadline = NO_DEADLINE;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (!poll_valid(events[i], *self))
+            return static_cast<uint64_t>(-1);
+        if (static_cast<PollSource>(events[i].source) == PollSource::Timer && events[i].arg < deadline)
+            deadline = events[i].arg;
+    }
+    if (a2 & POLL_NOWAIT)
+        return poll_scan(events, count);
+
+    WaitEntry entries[MAX_POLL];
+    for (;;) {
+        for (uint64_t i = 0; i < count; ++i) {
+            WaitQueue* queue = poll_queue(events[i]);
+            entries[i].process = self;
+            if (queue)
+                queue->add(entries[i]);
+        }
+        if (deadline != NO_DEADLINE) {
+            self->sleep_timer.callback = wake_poller;
+            self->sleep_timer.context = self;
+            timer_queue.arm(self->sleep_timer, deadline);
+        }
+        uint64_t ready = poll_scan(events, count);
+        if (ready == 0)
+            scheduler.sleep(*self);
+        timer_queue.cancel(self->sleep_timer);
+        for (uint64_t i = 0; i < count; ++i) {
+            if (entries[i].queue)
+                entries[i].queue->remove(entries[i]);
+        }
+        if (ready > 0)
+            return ready;
+    }
+}
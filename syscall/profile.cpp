@@ -0,0 +1,33 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+
+uint64_t syscall_profile(uint64_t a0, uint64_t a1) {
+    SyscallProfile* out = reinterpret_cast<SyscallProfile*>(a0);
+    size_t max_entries = static_cast<size_t>(a1);
+    if (max_entries == 0)
+        return 0;
+    if (!out)
+        return static_cast<uint64_t>(-1);
+    size_t count = 0;
+    for (uint64_t number = 0; number < SYSCALL_COUNT && count < max_entries; ++number) {
+        const SyscallEntry* entry = syscall_lookup(number);
+        if (!entry)
+            continue;
+        const SyscallCounters& counters = syscall_counters[number];
+        SyscallProfile& profile = out[count++];
+        size_t i = 0;
+        for (; i + 1 < SYSCALL_NAME_LEN && entry->name[i]; ++i)
+            profile.name[i] = entry->name[i];
+        for (; i < SYSCALL_NAME_LEN; ++i)
+            profile.name[i] = '\0';
+        profile.number = number;
+        profile.arity = entry->arity;
+        profile.calls = counters.calls;
+        profile.completed = counters.completed;
+        profile.total_cycles = counters.total_cycles;
+        profile.max_cycles = counters.max_cycles;
+        for (size_t b = 0; b < SYSCALL_HISTOGRAM_BUCKETS; ++b)
+            profile.histogram[b] = counters.histogram[b];
+    }
+    return count;
+}
@@ -0,0 +1,13 @@
+#include "syscall/impl.h"
+#include "drivers/serial.h"
+
+uint64_t syscall_purr(uint64_t a0, uint64_t a1) {
+    const void* buffer = reinterpret_cast<const void*>(a0);
+    uint32_t size = static_cast<uint32_t>(a1);
+    if (size > 0 && buffer == nullptr)
+        return static_cast<uint64_t>(-1);
+    if (!Serial::available())
+        return static_cast<uint64_t>(-1);
+    Serial::write(buffer, size);
+    return size;
+}
@@ -0,0 +1,14 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "percpu.h"
+
+uint64_t syscall_ring() {
+    Process* proc = this_cpu().current;
+    if (!proc)
+        return static_cast<uint64_t>(-1);
+    uint64_t addr = proc->setup_ring();
+    if (!addr)
+        return static_cast<uint64_t>(-1);
+    return addr;
+}
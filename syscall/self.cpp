@@ -0,0 +1,10 @@
+#include "syscall/impl.h"
+#include "process.h"
+#include "percpu.h"
+
+uint64_t syscall_self() {
+    Process* current = this_cpu().current;
+    if (!current)
+        return static_cast<uint64_t>(-1);
+    return current->pid;
+}
@@ -0,0 +1,19 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+
+uint64_t syscall_slice(uint64_t a0, uint64_t a1) {
+    PerCpu& cpu = this_cpu();
+    Process* target = a0 == 0 ? cpu.current : scheduler.find_process_by_pid(a0);
+    if (!target)
+        return static_cast<uint64_t>(-1);
+    uint64_t previous = scheduler.slice_for(*target);
+    if (a1 == 0)
+        return previous;
+    target->time_slice = a1;
+    if (target == cpu.current && cpu.quantum > a1)
+        cpu.quantum = a1;
+    return previous;
+}
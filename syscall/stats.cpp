@@ -0,0 +1,40 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "types/cpu.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+
+uint64_t syscall_stats(uint64_t a0, uint64_t a1) {
+    ProcStats* out = reinterpret_cast<ProcStats*>(a0);
+    size_t max_procs = static_cast<size_t>(a1);
+    if (max_procs == 0)
+        return 0;
+    if (!out)
+        return static_cast<uint64_t>(-1);
+    uint64_t now_tsc = rdtsc();
+    uint64_t now_ticks = scheduler.get_ticks();
+    size_t count = 0;
+    for (size_t i = 0; i < scheduler.process_count && count < max_procs; ++i) {
+        const Process& proc = *scheduler.processes[i];
+        ProcStats& entry = out[count++];
+        entry.pid = proc.pid;
+        entry.state = static_cast<uint64_t>(proc.state);
+        entry.priority = proc.priority;
+        entry.run_ticks = proc.stats.run_ticks;
+        entry.run_cycles = proc.stats.run_cycles;
+        entry.voluntary_switches = proc.stats.voluntary_switches;
+        entry.involuntary_switches = proc.stats.involuntary_switches;
+        entry.blocked_ticks = proc.stats.blocked_ticks;
+        entry.wakeups = proc.stats.wakeups;
+        entry.wake_latency_cycles = proc.stats.wake_latency_cycles;
+        entry.max_wake_latency_cycles = proc.stats.max_wake_latency_cycles;
+        entry.deadline_misses = proc.rt.deadline_misses;
+        entry.rt_throttles = proc.rt.throttles;
+        if (cpus[proc.cpu].current == &proc)
+            entry.run_cycles += now_tsc - proc.stats.run_start_tsc;
+        if (proc.state == ProcessState::Blocked)
+            entry.blocked_ticks += now_ticks - proc.stats.blocked_since;
+    }
+    return count;
+}
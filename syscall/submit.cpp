@@ -0,0 +1,48 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "percpu.h"
+
+static bool ring_op_allowed(const RingSqe& sqe) {
+    switch (sqe.opcode) {
+        case static_cast<uint64_t>(SyscallCodes::DROP):
+        case static_cast<uint64_t>(SyscallCodes::RING):
+        case static_cast<uint64_t>(SyscallCodes::SUBMIT):
+            return false;
+        case static_cast<uint64_t>(SyscallCodes::PLAY):
+            return sqe.args[1] != 0;
+    }
+    return syscall_lookup(sqe.opcode) != nullptr;
+}
+
+uint64_t syscall_submit(uint64_t a0) {
+    Process* proc = this_cpu().current;
+    if (!proc || !proc->ring)
+        return static_cast<uint64_t>(-1);
+    Ring* ring = proc->ring;
+    RingHeader& header = ring->header;
+    uint64_t limit = a0 ? a0 : RING_ENTRIES;
+    uint64_t consumed = 0;
+    while (consumed < limit) {
+        uint32_t sq_head = header.sq_head;
+        uint32_t sq_tail = __atomic_load_n(&header.sq_tail, __ATOMIC_ACQUIRE);
+        if (sq_head == sq_tail)
+            break;
+        uint32_t cq_tail = header.cq_tail;
+        if (cq_tail - __atomic_load_n(&header.cq_head, __ATOMIC_ACQUIRE) >= RING_ENTRIES)
+            break;
+        RingSqe sqe = ring->sq[sq_head & (RING_ENTRIES - 1)];
+        __atomic_store_n(&header.sq_head, sq_head + 1, __ATOMIC_RELEASE);
+        uint64_t result = static_cast<uint64_t>(-1);
+        if (ring_op_allowed(sqe))
+            result = syscall_invoke(sqe.opcode, sqe.args);
+        else
+            ++header.rejected;
+        RingCqe& cqe = ring->cq[cq_tail & (RING_ENTRIES - 1)];
+        cqe.user_data = sqe.user_data;
+        cqe.result = static_cast<int64_t>(result);
+        __atomic_store_n(&header.cq_tail, cq_tail + 1, __ATOMIC_RELEASE);
+        ++consumed;
+    }
+    return consumed;
+}
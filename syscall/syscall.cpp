@@ -3,47 +3,16 @@
 #include "types/cpu.h"
 #include "process.h"
 #include "scheduler.h"
+#include "spinlock.h"
 #include "drivers/keyboard.h"
-
-Process* current_process = nullptr;
-
-extern "C" {
-bool in_syscall = false;
-}
+#include "wait_queue.h"
 
 extern "C" void syscall_entry();
-extern "C" void process_restore_and_switch_to_ctx(cpu_context_t* to_ctx, uint64_t new_cr3);
-extern "C" void save_context_and_switch_to(cpu_context_t* save_ctx, void* resume_rip,
-                                           cpu_context_t* next_ctx, uint64_t next_cr3);
 
-static Process* keyboard_wait_head = nullptr;
-static Process* keyboard_wait_tail = nullptr;
-
-static void add_to_keyboard_wait(Process* p) {
-    p->wait_queue_next = nullptr;
-    if (keyboard_wait_tail)
-        keyboard_wait_tail->wait_queue_next = p;
-    else
-        keyboard_wait_head = p;
-    keyboard_wait_tail = p;
-}
-
-static void wake_one_keyboard_waiter() {
-    if (!keyboard_wait_head) return;
-    Process* p = keyboard_wait_head;
-    keyboard_wait_head = p->wait_queue_next;
-    if (!keyboard_wait_head)
-        keyboard_wait_tail = nullptr;
-    p->wait_queue_next = nullptr;
-    p->state = ProcessState::Runnable;
-}
+WaitQueue keyboard_queue;
 
 void wake_keyboard_waiters() {
-    wake_one_keyboard_waiter();
-}
-
-void keyboard_wait_add(Process* p) {
-    add_to_keyboard_wait(p);
+    keyboard_queue.wake_all();
 }
 
 void initialize_syscalls() {
@@ -59,29 +28,116 @@ void initialize_syscalls() {
     wrmsr(0xC0000084, 0x200);
 }
 
+namespace {
+
+template <typename... Args>
+constexpr uint8_t arity_of(uint64_t (*)(Args...)) {
+    return static_cast<uint8_t>(sizeof...(Args));
+}
+
+template <auto Fn>
+uint64_t invoke(const uint64_t* args) {
+    constexpr uint8_t arity = arity_of(Fn);
+    static_assert(arity <= SYSCALL_MAX_ARGS, "syscalls take at most five arguments");
+    if constexpr (arity == 0)
+        return Fn();
+    else if constexpr (arity == 1)
+        return Fn(args[0]);
+    else if constexpr (arity == 2)
+        return Fn(args[0], args[1]);
+    else if constexpr (arity == 3)
+        return Fn(args[0], args[1], args[2]);
+    else if constexpr (arity == 4)
+        return Fn(args[0], args[1], args[2], args[3]);
+    else
+        return Fn(args[0], args[1], args[2], args[3], args[4]);
+}
+
+struct SyscallTable {
+    SyscallEntry entries[SYSCALL_COUNT];
+
+    template <auto Fn>
+    constexpr void add(SyscallCodes code, const char* name) {
+        entries[static_cast<size_t>(code)] = { &invoke<Fn>, name, arity_of(Fn) };
+    }
+};
+
+constexpr SyscallTable build_syscall_table() {
+    SyscallTable table = {};
+    table.add<syscall_alive>(SyscallCodes::ALIVE, "alive");
+    table.add<syscall_feed>(SyscallCodes::FEED, "feed");
+    table.add<syscall_time>(SyscallCodes::TIME, "time");
+    table.add<syscall_play>(SyscallCodes::PLAY, "play");
+    table.add<syscall_pet>(SyscallCodes::PET, "pet");
+    table.add<syscall_meow>(SyscallCodes::MEOW, "meow");
+    table.add<syscall_drop>(SyscallCodes::DROP, "drop");
+    table.add<syscall_list>(SyscallCodes::LIST, "list");
+    table.add<syscall_wait>(SyscallCodes::WAIT, "wait");
+    table.add<syscall_slice>(SyscallCodes::SLICE, "slice");
+    table.add<syscall_clock>(SyscallCodes::CLOCK, "clock");
+    table.add<syscall_nap>(SyscallCodes::NAP, "nap");
+    table.add<syscall_yield>(SyscallCodes::YIELD, "yield");
+    table.add<syscall_stats>(SyscallCodes::STATS, "stats");
+    table.add<syscall_purr>(SyscallCodes::PURR, "purr");
+    table.add<syscall_self>(SyscallCodes::SELF, "self");
+    table.add<syscall_deadline>(SyscallCodes::DEADLINE, "deadline");
+    table.add<syscall_profile>(SyscallCodes::PROFILE, "profile");
+    table.add<syscall_ring>(SyscallCodes::RING, "ring");
+    table.add<syscall_submit>(SyscallCodes::SUBMIT, "submit");
+    table.add<syscall_meowv>(SyscallCodes::MEOWV, "meowv");
+    table.add<syscall_petv>(SyscallCodes::PETV, "petv");
+    table.add<syscall_tty>(SyscallCodes::TTY, "tty");
+    table.add<syscall_poll>(SyscallCodes::POLL, "poll");
+    return table;
+}
+
+constexpr SyscallTable syscall_table = build_syscall_table();
+
+size_t histogram_bucket(uint64_t cycles) {
+    size_t bucket = 0;
+    for (uint64_t v = cycles >> SYSCALL_HISTOGRAM_SHIFT; v && bucket + 1 < SYSCALL_HISTOGRAM_BUCKETS; v >>= 1)
+        ++bucket;
+    return bucket;
+}
+
+void record_latency(SyscallCounters& counters, uint64_t cycles) {
+    ++counters.completed;
+    counters.total_cycles += cycles;
+    if (cycles > counters.max_cycles)
+        counters.max_cycles = cycles;
+    ++counters.histogram[histogram_bucket(cycles)];
+}
+
+}
+
+SyscallCounters syscall_counters[SYSCALL_COUNT];
+bool syscall_profiling = true;
+
+const SyscallEntry* syscall_lookup(uint64_t number) {
+    if (number >= SYSCALL_COUNT || !syscall_table.entries[number].fn)
+        return nullptr;
+    return &syscall_table.entries[number];
+}
+
+uint64_t syscall_invoke(uint64_t number, const uint64_t* args) {
+    const SyscallEntry* entry = syscall_lookup(number);
+    if (!entry)
+        return static_cast<uint64_t>(-1);
+    if (!syscall_profiling)
+        return entry->fn(args);
+    SyscallCounters& counters = syscall_counters[number];
+    ++counters.calls;
+    uint64_t start = rdtsc();
+    uint64_t result = entry->fn(args);
+    record_latency(counters, rdtsc() - start);
+    return result;
+}
+
 uint64_t syscall_handler(uint64_t num, uint64_t a0, uint64_t a1,
     uint64_t a2, uint64_t a3, uint64_t a4) {
-    (void)a3;
-    (void)a4;
-    switch (num) {
-        case static_cast<uint64_t>(SyscallCodes::ALIVE):
-            return syscall_alive();
-        case static_cast<uint64_t>(SyscallCodes::FEED):
-            return syscall_feed(a0);
-        case static_cast<uint64_t>(SyscallCodes::TIME):
-            return syscall_time();
-        case static_cast<uint64_t>(SyscallCodes::PLAY):
-            return syscall_play(a0, a1, a2);
-        case static_cast<uint64_t>(SyscallCodes::PET):
-            return syscall_pet(a0, a1, a2);
-        case static_cast<uint64_t>(SyscallCodes::MEOW):
-            return syscall_meow(a0, a1, a2);
-        case static_cast<uint64_t>(SyscallCodes::DROP):
-            return syscall_drop();
-        case static_cast<uint64_t>(SyscallCodes::LIST):
-            return syscall_list(a0, a1);
-        case static_cast<uint64_t>(SyscallCodes::WAIT):
-            return syscall_wait(a0);
-    }
-    return static_cast<uint64_t>(-1);
+    kernel_lock.lock();
+    const uint64_t args[SYSCALL_MAX_ARGS] = { a0, a1, a2, a3, a4 };
+    uint64_t result = syscall_invoke(num, args);
+    kernel_lock.unlock();
+    return result;
 }
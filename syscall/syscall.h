@@ -2,6 +2,7 @@
 #include "types/types.h"
 
 class Process;
+class WaitQueue;
 
 enum class SyscallCodes : uint64_t {
     ALIVE = 0,
@@ -12,13 +13,168 @@ enum class SyscallCodes : uint64_t {
     MEOW = 5,
     DROP = 6,
     LIST = 7,
-    WAIT = 8
+    WAIT = 8,
+    SLICE = 9,
+    CLOCK = 10,
+    NAP = 11,
+    YIELD = 12,
+    STATS = 13,
+    PURR = 14,
+    SELF = 15,
+    DEADLINE = 16,
+    PROFILE = 17,
+    RING = 18,
+    SUBMIT = 19,
+    MEOWV = 20,
+    PETV = 21,
+    TTY = 22,
+    POLL = 23
 };
 
+constexpr size_t SYSCALL_COUNT = 24;
+constexpr size_t SYSCALL_MAX_ARGS = 5;
+constexpr size_t SYSCALL_NAME_LEN = 16;
+constexpr size_t SYSCALL_HISTOGRAM_BUCKETS = 16;
+constexpr uint32_t SYSCALL_HISTOGRAM_SHIFT = 8;
+
+using SyscallFn = uint64_t (*)(const uint64_t* args);
+
+struct SyscallEntry {
+    SyscallFn fn;
+    const char* name;
+    uint8_t arity;
+};
+
+struct SyscallCounters {
+    uint64_t calls;
+    uint64_t completed;
+    uint64_t total_cycles;
+    uint64_t max_cycles;
+    uint64_t histogram[SYSCALL_HISTOGRAM_BUCKETS];
+};
+
+struct ClockInfo {
+    uint64_t hz;
+    uint64_t ticks;
+    uint64_t tick_handler_calls;
+    uint64_t tick_handler_cycles;
+    uint64_t tick_handler_max_cycles;
+    uint64_t idle_entries;
+    uint64_t idle_cycles;
+    uint64_t tsc_hz;
+};
+
+struct ProcStats {
+    uint64_t pid;
+    uint64_t state;
+    uint64_t priority;
+    uint64_t run_ticks;
+    uint64_t run_cycles;
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+    uint64_t blocked_ticks;
+    uint64_t wakeups;
+    uint64_t wake_latency_cycles;
+    uint64_t max_wake_latency_cycles;
+    uint64_t deadline_misses;
+    uint64_t rt_throttles;
+};
+
+struct DeadlineParams {
+    uint64_t period;
+    uint64_t budget;
+    uint64_t deadline;
+};
+
+constexpr uint32_t MAX_IOV = 16;
+
+struct IoVec {
+    uint64_t base;
+    uint64_t len;
+};
+
+constexpr uint32_t MAX_POLL = 16;
+constexpr uint64_t POLL_NOWAIT = 1;
+
+enum class PollSource : uint32_t {
+    Keyboard = 1,
+    Child = 2,
+    Timer = 3
+};
+
+struct PollEvent {
+    uint32_t source;
+    uint32_t ready;
+    uint64_t arg;
+};
+
+constexpr uint64_t TIME_PAGE_VIRT = 0x40010000;
+
+struct TimePage {
+    uint32_t seq;
+    uint32_t hz;
+    uint64_t ticks;
+    uint64_t tick_tsc;
+    uint64_t tsc_hz;
+    uint64_t tsc_per_tick;
+    uint64_t boot_tsc;
+};
+
+constexpr uint64_t RING_VIRT = 0x40000000;
+constexpr uint32_t RING_ENTRIES = 64;
+constexpr size_t RING_PAGES = 2;
+
+struct RingHeader {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    uint32_t entries;
+    uint32_t reserved;
+    uint64_t rejected;
+    uint64_t pad[4];
+};
+
+struct RingSqe {
+    uint64_t opcode;
+    uint64_t args[SYSCALL_MAX_ARGS];
+    uint64_t user_data;
+};
+
+struct RingCqe {
+    uint64_t user_data;
+    int64_t result;
+};
+
+struct Ring {
+    RingHeader header;
+    RingSqe sq[RING_ENTRIES];
+    RingCqe cq[RING_ENTRIES];
+};
+
+static_assert(sizeof(RingHeader) == 64, "ring header fills one cache line");
+static_assert(sizeof(Ring) <= RING_PAGES * 4096, "ring must fit in its mapping");
+static_assert((RING_ENTRIES & (RING_ENTRIES - 1)) == 0, "ring size must be a power of two");
+
+struct SyscallProfile {
+    char name[SYSCALL_NAME_LEN];
+    uint64_t number;
+    uint64_t arity;
+    uint64_t calls;
+    uint64_t completed;
+    uint64_t total_cycles;
+    uint64_t max_cycles;
+    uint64_t histogram[SYSCALL_HISTOGRAM_BUCKETS];
+};
+
+const SyscallEntry* syscall_lookup(uint64_t number);
+uint64_t syscall_invoke(uint64_t number, const uint64_t* args);
+extern SyscallCounters syscall_counters[SYSCALL_COUNT];
+extern bool syscall_profiling;
+
 void initialize_syscalls();
 extern "C" uint64_t syscall_handler(uint64_t number, uint64_t a0,
     uint64_t a1, uint64_t a2, uint64_t a3, uint64_t a4);
 
-extern Process* current_process;
 void wake_keyboard_waiters();
-void keyboard_wait_add(Process* p);
+extern WaitQueue keyboard_queue;
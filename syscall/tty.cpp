@@ -0,0 +1,8 @@
+#include "syscall/impl.h"
+#include "drivers/tty.h"
+
+uint64_t syscall_tty(uint64_t a0) {
+    if (a0 > static_cast<uint64_t>(TtyMode::Raw))
+        return static_cast<uint64_t>(-1);
+    return static_cast<uint64_t>(Tty::set_mode(static_cast<TtyMode>(a0)));
+}
@@ -0,0 +1,24 @@
+#include "syscall/impl.h"
+#include "syscall/syscall.h"
+#include "process.h"
+#include "scheduler.h"
+#include "percpu.h"
+
+uint64_t syscall_yield(uint64_t a0) {
+    Process* yielding = this_cpu().current;
+    if (!yielding)
+        return static_cast<uint64_t>(-1);
+    Process* next = nullptr;
+    if (a0 == 0) {
+        next = scheduler.yield();
+    } else {
+        Process* target = scheduler.find_process_by_pid(a0);
+        if (!target)
+            return static_cast<uint64_t>(-1);
+        next = scheduler.yield_to(*target);
+        if (!next)
+            return static_cast<uint64_t>(-1);
+    }
+    scheduler.switch_to(yielding, next);
+    return 0;
+}
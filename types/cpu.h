@@ -50,8 +50,28 @@ inline void disable_interrupts() {
 inline void halt() {
     asm volatile("hlt");
 }
+
+inline void enable_interrupts_and_halt() {
+    asm volatile("sti; hlt");
+}
+inline uint64_t rdmsr(uint32_t addr) {
+    uint32_t low = 0;
+    uint32_t high = 0;
+    asm volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(addr));
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
+
 inline void wrmsr(uint32_t addr, uint64_t value) {
     uint32_t low = value & 0xFFFFFFFF;
     uint32_t high = value >> 32;
     asm volatile("wrmsr" : : "c"(addr), "a"(low), "d"(high));
-}
\ No newline at end of file
+}
+inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t& eax, uint32_t& ebx, uint32_t& ecx, uint32_t& edx) {
+    asm volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(leaf), "c"(subleaf));
+}
+
+inline uint64_t rdtsc() {
+    uint32_t low, high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
@@ -4,6 +4,7 @@
 class PageOrchestrator;
 
 #define PAGE_BITMAP_SIZE (2 * 1024 * 1024)
+#define INIT_NAME_LEN 64
 
 struct kernel_basic_info_t {
     char* mem_begin;
@@ -14,6 +15,12 @@ struct kernel_basic_info_t {
     uint64_t* pml4_table;
     uint16_t (*frame_buffer)[80];
     PageOrchestrator* page_orchestrator;
+    uint32_t timer_hz;
+    uint64_t quantum;
+    uint32_t sched_policy;
+    uint32_t max_cpus;
+    bool syscall_profiling;
+    char init_name[INIT_NAME_LEN];
 };
 
 extern "C" {
@@ -28,6 +28,11 @@ struct multiboot_tag_header_t {
     uint32_t size;
 } __attribute__((packed));
 
+struct multiboot2_tag_string_t {
+    multiboot_tag_header_t header;
+    char string[];
+} __attribute__((packed));
+
 struct multiboot2_tag_basic_mem_t {
     multiboot_tag_header_t header;
     uint32_t mem_lower;